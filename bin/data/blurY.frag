@@ -16,7 +16,7 @@ void main()
     color += 3.0 * texture(tex0, texCoordVarying + vec2(0.0, blurAmnt * -2.0));
     color += 4.0 * texture(tex0, texCoordVarying + vec2(0.0, blurAmnt * -1.0));
     
-    color += 5.0 * texture(tex0, texCoordVarying + vec2(0.0, blurAmnt));
+    color += 5.0 * texture(tex0, texCoordVarying + vec2(0.0, 0.0));
     
     color += 4.0 * texture(tex0, texCoordVarying + vec2(0.0, blurAmnt * 1.0));
     color += 3.0 * texture(tex0, texCoordVarying + vec2(0.0, blurAmnt * 2.0));
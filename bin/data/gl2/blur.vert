@@ -0,0 +1,6 @@
+#version 120
+
+void main(){
+    gl_TexCoord[0] = gl_MultiTexCoord0;
+    gl_Position = ftransform();
+}
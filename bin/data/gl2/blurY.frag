@@ -0,0 +1,27 @@
+#version 120
+#extension GL_ARB_texture_rectangle : enable
+
+uniform sampler2DRect tex0;
+uniform float blurAmnt;
+    
+void main()
+{
+    vec2 texCoord = gl_TexCoord[0].st;
+    vec4 color = vec4(0.0, 0.0, 0.0, 0.0);
+    
+    color += 1.0 * texture2DRect(tex0, texCoord + vec2(0.0, blurAmnt * -4.0));
+    color += 2.0 * texture2DRect(tex0, texCoord + vec2(0.0, blurAmnt * -3.0));
+    color += 3.0 * texture2DRect(tex0, texCoord + vec2(0.0, blurAmnt * -2.0));
+    color += 4.0 * texture2DRect(tex0, texCoord + vec2(0.0, blurAmnt * -1.0));
+    
+    color += 5.0 * texture2DRect(tex0, texCoord);
+    
+    color += 4.0 * texture2DRect(tex0, texCoord + vec2(0.0, blurAmnt * 1.0));
+    color += 3.0 * texture2DRect(tex0, texCoord + vec2(0.0, blurAmnt * 2.0));
+    color += 2.0 * texture2DRect(tex0, texCoord + vec2(0.0, blurAmnt * 3.0));
+    color += 1.0 * texture2DRect(tex0, texCoord + vec2(0.0, blurAmnt * 4.0));
+    
+    color /= 25.0;
+    
+    gl_FragColor = 1.25 * color;
+}
@@ -0,0 +1,127 @@
+#include "Allocations.h"
+#include "ofMain.h"
+
+#include <assert.h>
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+/* Bytes in front of every allocation, recording its size and
+ * subsystem. A multiple of 16 keeps the allocation aligned. */
+#define HEADER_SIZE 16
+
+struct AllocationHeader {
+    size_t size;
+    int subsystem;
+};
+
+struct AtomicTotals {
+    std::atomic<uint64_t> calls;
+    std::atomic<uint64_t> bytes;
+    std::atomic<int64_t> liveBytes;
+};
+
+/* Zero-initialized before any allocation, since it has static
+ * storage and no constructor runs for it. */
+static AtomicTotals totals[Allocations::SUBSYSTEM_COUNT];
+
+static Allocations::Totals lastTotals[Allocations::SUBSYSTEM_COUNT];
+static Allocations::Totals frameTotals[Allocations::SUBSYSTEM_COUNT];
+
+static thread_local Allocations::Subsystem currentSubsystem = Allocations::OTHER;
+
+/* Names, in |Allocations::Subsystem| order. */
+static const char* SUBSYSTEM_NAMES[] = {
+    "other",
+    "level load",
+    "level update",
+    "level draw",
+    "mixer control",
+    "audio callback"
+};
+
+uint64_t Allocations::getCount() {
+    uint64_t count = 0;
+    for (int i = 0; i < SUBSYSTEM_COUNT; i++) {
+        count += totals[i].calls.load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+Allocations::Totals Allocations::getTotals(Subsystem subsystem) {
+    Totals result;
+    result.calls = totals[subsystem].calls.load(std::memory_order_relaxed);
+    result.bytes = totals[subsystem].bytes.load(std::memory_order_relaxed);
+    result.liveBytes = totals[subsystem].liveBytes.load(std::memory_order_relaxed);
+    return result;
+}
+
+Allocations::Totals Allocations::getFrameTotals(Subsystem subsystem) {
+    return frameTotals[subsystem];
+}
+
+void Allocations::endFrame() {
+    for (int i = 0; i < SUBSYSTEM_COUNT; i++) {
+        Totals current = getTotals((Subsystem)i);
+        frameTotals[i].calls = current.calls - lastTotals[i].calls;
+        frameTotals[i].bytes = current.bytes - lastTotals[i].bytes;
+        frameTotals[i].liveBytes = current.liveBytes - lastTotals[i].liveBytes;
+        lastTotals[i] = current;
+    }
+}
+
+void Allocations::log() {
+    for (int i = 0; i < SUBSYSTEM_COUNT; i++) {
+        Totals frame = getFrameTotals((Subsystem)i);
+        Totals total = getTotals((Subsystem)i);
+        ofLogNotice("Allocations") << getName((Subsystem)i)
+            << ": last frame " << frame.calls << " calls, " << frame.bytes << " bytes, "
+            << frame.liveBytes << " live bytes; total " << total.calls << " calls, "
+            << total.bytes << " bytes, " << total.liveBytes << " live bytes";
+    }
+}
+
+const char* Allocations::getName(Subsystem subsystem) {
+    return SUBSYSTEM_NAMES[subsystem];
+}
+
+Allocations::Subsystem Allocations::getSubsystem() {
+    return currentSubsystem;
+}
+
+void Allocations::setSubsystem(Subsystem subsystem) {
+    currentSubsystem = subsystem;
+}
+
+/* Replacements for the global allocation functions. The array and
+ * nothrow forms of the standard library call these. */
+void* operator new(size_t size) {
+    Allocations::Subsystem subsystem = currentSubsystem;
+    
+    // The audio callback must never wait on the allocator.
+    assert(subsystem != Allocations::AUDIO_CALLBACK);
+    
+    char* block = (char *)malloc(size + HEADER_SIZE);
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    AllocationHeader* header = (AllocationHeader *)block;
+    header->size = size;
+    header->subsystem = subsystem;
+    
+    AtomicTotals& subsystemTotals = totals[subsystem];
+    subsystemTotals.calls.fetch_add(1, std::memory_order_relaxed);
+    subsystemTotals.bytes.fetch_add(size, std::memory_order_relaxed);
+    subsystemTotals.liveBytes.fetch_add(size, std::memory_order_relaxed);
+    return block + HEADER_SIZE;
+}
+
+void operator delete(void* pointer) noexcept {
+    if (!pointer) {
+        return;
+    }
+    char* block = (char *)pointer - HEADER_SIZE;
+    AllocationHeader* header = (AllocationHeader *)block;
+    totals[header->subsystem].liveBytes.fetch_sub(header->size, std::memory_order_relaxed);
+    free(block);
+}
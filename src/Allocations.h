@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stdint.h>
+
+/* Counts heap allocations made through global operator new, on any
+ * thread, and attributes them to the subsystem that was active on
+ * the allocating thread. Mark a subsystem with
+ *
+ *     AllocationScope scope(Allocations::LEVEL_UPDATE);
+ *
+ * Frees are credited back to the subsystem that made the allocation,
+ * so live bytes show where long-session memory growth comes from.
+ * Debug builds assert if the audio callback allocates. See
+ * Allocations.cpp for the replaced operators. */
+class Allocations
+{
+public:
+    enum Subsystem {
+        OTHER,
+        LEVEL_LOAD,
+        LEVEL_UPDATE,
+        LEVEL_DRAW,
+        MIXER_CONTROL,
+        AUDIO_CALLBACK,
+        SUBSYSTEM_COUNT
+    };
+    
+    struct Totals {
+        uint64_t calls;
+        uint64_t bytes;
+        int64_t liveBytes;
+    };
+    
+    /* Allocations since the app started. */
+    static uint64_t getCount();
+    
+    /* Totals since the app started. */
+    static Totals getTotals(Subsystem subsystem);
+    
+    /* Totals of the last frame closed by |endFrame|. Live bytes are
+     * the change over the frame. */
+    static Totals getFrameTotals(Subsystem subsystem);
+    
+    /* Closes the current frame. Main thread only. */
+    static void endFrame();
+    
+    /* Logs the last frame's and the cumulative totals. */
+    static void log();
+    
+    static const char* getName(Subsystem subsystem);
+    
+    /* Subsystem of the calling thread. Use |AllocationScope| to set. */
+    static Subsystem getSubsystem();
+    static void setSubsystem(Subsystem subsystem);
+};
+
+/* Attributes allocations on this thread to |subsystem| until the end
+ * of the block, then restores the previous subsystem. */
+class AllocationScope
+{
+public:
+    AllocationScope(Allocations::Subsystem subsystem)
+    : previous(Allocations::getSubsystem()) {
+        Allocations::setSubsystem(subsystem);
+    }
+    
+    ~AllocationScope() {
+        Allocations::setSubsystem(previous);
+    }
+    
+private:
+    Allocations::Subsystem previous;
+};
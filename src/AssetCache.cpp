@@ -0,0 +1,29 @@
+#include "AssetCache.h"
+
+std::map<std::string, std::weak_ptr<ofTrueTypeFont> > AssetCache::fonts;
+std::map<std::string, std::weak_ptr<ofImage> > AssetCache::images;
+
+std::shared_ptr<ofTrueTypeFont> AssetCache::getFont(const std::string filename, int size) {
+    std::ostringstream key;
+    key << filename << "@" << size;
+    
+    std::weak_ptr<ofTrueTypeFont>& entry = fonts[key.str()];
+    std::shared_ptr<ofTrueTypeFont> font = entry.lock();
+    if (!font) {
+        font = std::shared_ptr<ofTrueTypeFont>(new ofTrueTypeFont());
+        font->loadFont(filename, size, true, true);
+        entry = font;
+    }
+    return font;
+}
+
+std::shared_ptr<ofImage> AssetCache::getImage(const std::string filename) {
+    std::weak_ptr<ofImage>& entry = images[filename];
+    std::shared_ptr<ofImage> image = entry.lock();
+    if (!image) {
+        image = std::shared_ptr<ofImage>(new ofImage());
+        image->loadImage(filename);
+        entry = image;
+    }
+    return image;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "ofMain.h"
+
+/* Shared cache of fonts and images. Assets are loaded on first
+ * use and shared by everyone who asks for the same file, and are
+ * released once the last reference to them goes away. Must only
+ * be used from the main thread, since loading creates textures. */
+class AssetCache
+{
+public:
+    /* Returns the font loaded from |filename| at |size|. */
+    static std::shared_ptr<ofTrueTypeFont> getFont(const std::string filename, int size);
+    
+    /* Returns the image loaded from |filename|. */
+    static std::shared_ptr<ofImage> getImage(const std::string filename);
+    
+private:
+    static std::map<std::string, std::weak_ptr<ofTrueTypeFont> > fonts;
+    static std::map<std::string, std::weak_ptr<ofImage> > images;
+};
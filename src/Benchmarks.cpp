@@ -0,0 +1,416 @@
+#include "Benchmarks.h"
+#include "GameClock.h"
+#include "Level.h"
+#include "LevelDescription.h"
+#include "StressLevel.h"
+#include "Tunables.h"
+
+#include <chrono>
+#include <fstream>
+#include <random>
+
+/* Frames per mixer block, as in the app's sound stream. */
+#define MIXER_BLOCK 1024
+
+/* Seed for all random object placement. */
+#define BENCH_SEED 1
+
+/* Frame rate the sweep simulates, and the frames it runs before and
+ * while timing. The warm-up lets particles spread over the level. */
+#define SWEEP_FPS 60
+#define SWEEP_WARM_UP_FRAMES 180
+#define SWEEP_FRAMES 60
+
+/* Largest multiple of the base counts swept, and the median frame
+ * time at which a sweep stops growing. */
+#define SWEEP_MAX_FACTOR 2048
+#define SWEEP_MAX_FRAME_US 200000
+
+typedef std::chrono::steady_clock Clock;
+
+/* A physics world and mixer of its own for each case, so cases don't
+ * affect each other and the app's mixer never plays. */
+struct BenchWorld {
+    ofSoundMixer mixer;
+    ofxBox2d box2d;
+    
+    BenchWorld()
+    : mixer(NULL, 0) {
+        box2d.init();
+        box2d.setGravity(0, 10);
+        box2d.setFPS(Tunables::get(Tunables::PHYSICS_FPS));
+        box2d.enableEvents();
+        Level::Initialize(&box2d, &mixer);
+        SoundSource::Initialize(&mixer);
+        SoundParticle::Initialize(&mixer);
+        ParticleSink::Initialize(&mixer);
+    }
+};
+
+/* Counts contacts started in a world. */
+struct ContactCounter {
+    int count = 0;
+    void onContactStart(ofxBox2dContactArgs &e) {
+        count++;
+    }
+};
+
+/* Collects the durations of one case and writes them out. */
+class BenchResult
+{
+public:
+    BenchResult(const std::string name)
+    : name(name) {
+    }
+    
+    /* Adds a parameter of the case, written before the timings. */
+    template <class T>
+    void param(const std::string key, const T& value) {
+        params << ",\"" << key << "\":" << value;
+    }
+    void param(const std::string key, const std::string value) {
+        params << ",\"" << key << "\":\"" << value << "\"";
+    }
+    
+    void start() {
+        startTime = Clock::now();
+    }
+    
+    void stop() {
+        samples.push_back(std::chrono::duration<double, std::micro>(Clock::now() - startTime).count());
+    }
+    
+    void write(std::ostream& out) {
+        std::sort(samples.begin(), samples.end());
+        double total = 0;
+        for (int i = 0; i < samples.size(); i++) {
+            total += samples[i];
+        }
+        std::ostringstream line;
+        line << "{\"name\":\"" << name << "\"" << params.str()
+             << ",\"iterations\":" << samples.size()
+             << ",\"min_us\":" << samples.front()
+             << ",\"median_us\":" << samples[samples.size() / 2]
+             << ",\"mean_us\":" << total / samples.size() << "}";
+        out << line.str() << std::endl;
+        std::cout << line.str() << std::endl;
+    }
+    
+private:
+    std::string name;
+    std::ostringstream params;
+    Clock::time_point startTime;
+    std::vector<double> samples;
+};
+
+static void benchMixer(std::ostream& out) {
+    const int voiceCounts[] = { 1, 8, 64, 512 };
+    const char* modeNames[] = { "sin", "triangle", "square", "saw" };
+    std::vector<float> buffer(MIXER_BLOCK * 2);
+    for (int mode = SIN_MODE; mode <= SAW_MODE; mode++) {
+        for (int i = 0; i < 4; i++) {
+            int voices = voiceCounts[i];
+            ofSoundMixer mixer(NULL, 0);
+            mixer.SetMode((SMSoundMode)mode);
+            for (int j = 0; j < voices; j++) {
+                SMSoundProperties properties;
+                properties.volume = 0.f;
+                properties.freq = 220.f + j;
+                mixer.Play(mixer.AddSource(properties), 1.f);
+            }
+            
+            BenchResult result("mixer");
+            result.param("mode", std::string(modeNames[mode]));
+            result.param("voices", voices);
+            result.param("block", MIXER_BLOCK);
+            mixer.audioOut(&buffer[0], MIXER_BLOCK, 2, 0, 0);
+            for (int j = 0; j < 100; j++) {
+                result.start();
+                mixer.audioOut(&buffer[0], MIXER_BLOCK, 2, 0, 0);
+                result.stop();
+            }
+            result.write(out);
+        }
+    }
+}
+
+static void benchResonators(std::ostream& out) {
+    const int strikeCounts[] = { 16, 64, 256 };
+    std::vector<float> buffer(MIXER_BLOCK * 2);
+    for (int i = 0; i < 3; i++) {
+        int strikes = strikeCounts[i];
+        ofSoundMixer mixer(NULL, 0);
+        
+        BenchResult result("resonators");
+        result.param("strikes", strikes);
+        result.param("block", MIXER_BLOCK);
+        for (int j = 0; j < 100; j++) {
+            // Keep all strikes ringing, outside of the timing.
+            for (int k = 0; k < strikes; k++) {
+                mixer.Strike(-1, (ResonatorMaterial)(k % 3), 1.f);
+            }
+            result.start();
+            mixer.audioOut(&buffer[0], MIXER_BLOCK, 2, 0, 0);
+            result.stop();
+        }
+        result.param("ringing", mixer.GetRingingCount());
+        result.write(out);
+    }
+}
+
+static void benchLevelUpdate(std::ostream& out) {
+    const int particleCounts[] = { 10, 100, 1000, 10000 };
+    const int circleCounts[] = { 1, 10, 100, 500 };
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            std::mt19937 random(BENCH_SEED);
+            std::uniform_real_distribution<float> x(0, ofGetWidth());
+            std::uniform_real_distribution<float> y(0, ofGetHeight());
+            
+            LevelDescription description;
+            for (int k = 0; k < circleCounts[j]; k++) {
+                SoundDescription sound = { x(random), y(random), 440.f };
+                description.sounds.push_back(sound);
+            }
+            
+            BenchWorld world;
+            Level* level = new Level(description);
+            for (int k = 0; k < particleCounts[i]; k++) {
+                level->addParticle(x(random), y(random), 440.f);
+            }
+            
+            // Physics isn't stepped, so particles stay where they are
+            // and every iteration does the same work.
+            BenchResult result("level_update");
+            result.param("particles", particleCounts[i]);
+            result.param("circles", circleCounts[j]);
+            level->update();
+            for (int k = 0; k < 20; k++) {
+                result.start();
+                level->update();
+                result.stop();
+            }
+            result.write(out);
+            delete level;
+        }
+    }
+}
+
+static void benchLevelLoad(std::ostream& out) {
+    // A very large level, written next to the shipped ones.
+    std::mt19937 random(BENCH_SEED);
+    std::uniform_real_distribution<float> x(0, ofGetWidth());
+    std::uniform_real_distribution<float> y(0, ofGetHeight());
+    LevelDescription large;
+    large.title = "Benchmark";
+    for (int i = 0; i < 5000; i++) {
+        BoxDescription box = { x(random), y(random), 20, 20 };
+        large.boxes.push_back(box);
+        SoundDescription sound = { x(random), y(random), 440.f };
+        large.sounds.push_back(sound);
+    }
+    for (int i = 0; i < 4; i++) {
+        SinkDescription sink = { x(random), y(random), 440.f, 10 };
+        large.sinks.push_back(sink);
+    }
+    std::string largePath = ofToDataPath("bench-large.txt", true);
+    std::ofstream largeFile(largePath.c_str());
+    large.write(largeFile);
+    largeFile.close();
+    
+    const char* files[] = { "level1.txt", "bench-large.txt" };
+    const char* sizes[] = { "small", "large" };
+    for (int i = 0; i < 2; i++) {
+        BenchWorld world;
+        BenchResult result("level_load");
+        result.param("size", std::string(sizes[i]));
+        for (int j = 0; j < 5; j++) {
+            result.start();
+            Level* level = new Level(files[i]);
+            result.stop();
+            delete level;
+        }
+        result.write(out);
+    }
+    std::remove(largePath.c_str());
+}
+
+static void benchContactStorm(std::ostream& out) {
+    const int particleCounts[] = { 500, 2000 };
+    for (int i = 0; i < 2; i++) {
+        float width = ofGetWidth();
+        float height = ofGetHeight();
+        
+        // A walled pit with particles packed tightly enough to
+        // overlap, so every step starts and ends many contacts.
+        LevelDescription description;
+        BoxDescription floor = { width / 2, height - 10, width, 20 };
+        BoxDescription left = { 10, height / 2, 20, height };
+        BoxDescription right = { width - 10, height / 2, 20, height };
+        description.boxes.push_back(floor);
+        description.boxes.push_back(left);
+        description.boxes.push_back(right);
+        
+        BenchWorld world;
+        ContactCounter counter;
+        ofAddListener(world.box2d.contactStartEvents, &counter, &ContactCounter::onContactStart);
+        Level* level = new Level(description);
+        int columns = (width - 60) / 18;
+        for (int j = 0; j < particleCounts[i]; j++) {
+            level->addParticle(30 + (j % columns) * 18, height - 30 - (j / columns) * 18, 440.f);
+        }
+        
+        BenchResult result("contact_storm");
+        result.param("particles", particleCounts[i]);
+        for (int j = 0; j < 60; j++) {
+            result.start();
+            world.box2d.update();
+            level->update();
+            result.stop();
+        }
+        result.param("contacts", counter.count);
+        result.write(out);
+        delete level;
+        ofRemoveListener(world.box2d.contactStartEvents, &counter, &ContactCounter::onContactStart);
+    }
+}
+
+/* Median of |samples|, which it sorts. */
+static double median(std::vector<double>& samples) {
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+static double elapsedMicros(Clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+/* Plays one stress level headless and writes its timings. Returns
+ * the median frame time. */
+static double sweepLevel(std::ostream& out, const std::string objects, const StressParameters& parameters) {
+    LevelDescription description;
+    StressLevel::generate(parameters, BENCH_SEED, description);
+    
+    BenchWorld world;
+    GameClock::setTime(0);
+    Level* level = new Level(description);
+    int audioFrames = world.mixer.GetSampleRate() / SWEEP_FPS;
+    std::vector<float> buffer(audioFrames * 2);
+    
+    std::vector<double> frame, physics, update, draw, audio;
+    double particles = 0, voices = 0;
+    for (int i = 0; i < SWEEP_WARM_UP_FRAMES + SWEEP_FRAMES; i++) {
+        GameClock::setTime((float)i / SWEEP_FPS);
+        
+        // Everything a frame does, in the order the app does it,
+        // with the mixer rendering the audio of one frame. The GPU is
+        // synchronized around drawing, so draw time includes
+        // rendering and not just submitting the commands.
+        glFinish();
+        Clock::time_point start = Clock::now();
+        world.box2d.update();
+        double physicsTime = elapsedMicros(start);
+        
+        Clock::time_point updateStart = Clock::now();
+        level->update();
+        double updateTime = elapsedMicros(updateStart);
+        
+        Clock::time_point drawStart = Clock::now();
+        level->draw();
+        glFinish();
+        double drawTime = elapsedMicros(drawStart);
+        
+        Clock::time_point audioStart = Clock::now();
+        world.mixer.audioOut(&buffer[0], audioFrames, 2, 0, 0);
+        double audioTime = elapsedMicros(audioStart);
+        double frameTime = elapsedMicros(start);
+        
+        if (i < SWEEP_WARM_UP_FRAMES) {
+            continue;
+        }
+        frame.push_back(frameTime);
+        physics.push_back(physicsTime);
+        update.push_back(updateTime);
+        draw.push_back(drawTime);
+        audio.push_back(audioTime);
+        particles += level->getParticleCount();
+        voices += world.mixer.GetActiveSourceCount();
+    }
+    delete level;
+    
+    std::ostringstream line;
+    line << "{\"name\":\"sweep\",\"objects\":\"" << objects << "\""
+         << ",\"sources\":" << parameters.sources
+         << ",\"pattern\":" << parameters.patternLength
+         << ",\"sounds\":" << parameters.sounds
+         << ",\"boxes\":" << parameters.boxes
+         << ",\"sinks\":" << parameters.sinks
+         << ",\"particles\":" << particles / SWEEP_FRAMES
+         << ",\"voices\":" << voices / SWEEP_FRAMES
+         << ",\"frames\":" << SWEEP_FRAMES
+         << ",\"frame_us\":" << median(frame)
+         << ",\"physics_us\":" << median(physics)
+         << ",\"update_us\":" << median(update)
+         << ",\"draw_us\":" << median(draw)
+         << ",\"audio_us\":" << median(audio) << "}";
+    out << line.str() << std::endl;
+    std::cout << line.str() << std::endl;
+    return median(frame);
+}
+
+/* Sweeps the count of one kind of object from 1 up, with the other
+ * counts as in |parameters|, or all counts if |count| is NULL. */
+static void sweepObjects(std::ostream& out, const std::string objects, const StressParameters& parameters,
+                         int StressParameters::*count) {
+    for (int factor = 1; factor <= SWEEP_MAX_FACTOR; factor *= 2) {
+        StressParameters scaled = StressLevel::scale(parameters, factor);
+        if (count) {
+            scaled = parameters;
+            scaled.*count = factor;
+        }
+        if (sweepLevel(out, objects, scaled) > SWEEP_MAX_FRAME_US) {
+            return;
+        }
+    }
+}
+
+bool Benchmarks::sweep(const std::string path) {
+    std::ofstream out(path.c_str());
+    if (!out) {
+        std::cerr << "Could not write sweep results to " << path << std::endl;
+        return false;
+    }
+    
+    // A few sources of every frequency keep particles coming while
+    // the other kinds grow.
+    StressParameters base;
+    base.sources = 4;
+    base.patternLength = 3;
+    sweepObjects(out, "sources", base, &StressParameters::sources);
+    sweepObjects(out, "sounds", base, &StressParameters::sounds);
+    sweepObjects(out, "boxes", base, &StressParameters::boxes);
+    sweepObjects(out, "sinks", base, &StressParameters::sinks);
+    
+    StressParameters all;
+    all.sources = 1;
+    all.patternLength = 3;
+    all.sounds = 2;
+    all.boxes = 2;
+    all.sinks = 1;
+    sweepObjects(out, "all", all, NULL);
+    return true;
+}
+
+bool Benchmarks::run(const std::string path) {
+    std::ofstream out(path.c_str());
+    if (!out) {
+        std::cerr << "Could not write benchmark results to " << path << std::endl;
+        return false;
+    }
+    benchMixer(out);
+    benchResonators(out);
+    benchLevelUpdate(out);
+    benchLevelLoad(out);
+    benchContactStorm(out);
+    return true;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "ofMain.h"
+
+/* Repeatable microbenchmarks for the mixer, level updates, level
+ * loading and contact handling. Every case uses fixed sizes, seeds
+ * and iteration counts, so results can be compared between builds.
+ * Results are written as JSON lines, one object per case:
+ *
+ *   {"name":"mixer","mode":"sin","voices":64,"block":1024,"iterations":100,
+ *    "min_us":..,"median_us":..,"mean_us":..}
+ *
+ * Needs a GL context for fonts, so run it from a running app with
+ * `soundSurfer --bench <file>`, or with `make bench`. The scaling
+ * sweep is run the same way with `--sweep` or `make sweep`. */
+class Benchmarks
+{
+public:
+    /* Runs every case, printing each result to stdout and writing it
+     * to the given absolute path. Returns false if the file could not
+     * be written. */
+    static bool run(const std::string path);
+    
+    /* Plays stress levels of growing size off-screen, one kind of
+     * object at a time and then all together, and writes the median
+     * frame, physics, update, draw and audio time of each size like
+     * |run|. A kind stops growing once its frames take too long. */
+    static bool sweep(const std::string path);
+};
@@ -0,0 +1,99 @@
+#include "Bloom.h"
+
+/* Distance between blur taps, in low resolution pixels. The shaders
+ * always sample 9 taps, so this sets the glow radius. */
+#define BLUR_SPREAD 1.5f
+
+Bloom::Bloom()
+: quality(BLOOM_OFF), loaded(false), width(0), height(0) {
+}
+
+void Bloom::setQuality(Quality quality) {
+    if (quality != this->quality) {
+        this->quality = quality;
+        
+        // Reallocate buffers on the next |begin|.
+        width = height = 0;
+    }
+}
+
+Bloom::Quality Bloom::getQuality() const {
+    return quality;
+}
+
+bool Bloom::isEnabled() const {
+    return quality != BLOOM_OFF && (!loaded || (blurX.isLoaded() && blurY.isLoaded()));
+}
+
+void Bloom::begin(int width, int height) {
+    if (!loaded) {
+        load();
+    }
+    if (width != this->width || height != this->height) {
+        allocate(width, height);
+    }
+    scene.begin();
+    ofClear(0, 0, 0, 255);
+}
+
+void Bloom::end() {
+    scene.end();
+    
+    ofPushStyle();
+    ofSetColor(255, 255, 255, 255);
+    ofDisableBlendMode();
+    scene.draw(0, 0);
+    if (!blurX.isLoaded() || !blurY.isLoaded()) {
+        ofPopStyle();
+        return;
+    }
+    
+    // Downsample.
+    ping.begin();
+    ofClear(0, 0, 0, 255);
+    scene.draw(0, 0, ping.getWidth(), ping.getHeight());
+    ping.end();
+    
+    // Blur horizontally into |pong|, then vertically back into |ping|.
+    pong.begin();
+    ofClear(0, 0, 0, 255);
+    blurX.begin();
+    blurX.setUniform1f("blurAmnt", BLUR_SPREAD);
+    ping.draw(0, 0);
+    blurX.end();
+    pong.end();
+    
+    ping.begin();
+    ofClear(0, 0, 0, 255);
+    blurY.begin();
+    blurY.setUniform1f("blurAmnt", BLUR_SPREAD);
+    pong.draw(0, 0);
+    blurY.end();
+    ping.end();
+    
+    // Add the glow back on top, upsampled with linear filtering.
+    ofEnableBlendMode(OF_BLENDMODE_ADD);
+    ping.draw(0, 0, width, height);
+    ofPopStyle();
+}
+
+void Bloom::load() {
+    // The bundled shaders need the programmable renderer; the
+    // fixed-function renderer gets GLSL 1.20 versions of them.
+    std::string directory = ofIsGLProgrammableRenderer() ? "" : "gl2/";
+    blurX.load(directory + "blur.vert", directory + "blurX.frag");
+    blurY.load(directory + "blur.vert", directory + "blurY.frag");
+    loaded = true;
+    if (!blurX.isLoaded() || !blurY.isLoaded()) {
+        ofLogWarning("Bloom") << "Could not load blur shaders, bloom disabled";
+    }
+}
+
+void Bloom::allocate(int width, int height) {
+    this->width = width;
+    this->height = height;
+    int divisor = quality == BLOOM_HALF ? 2 : 4;
+    scene.allocate(width, height, GL_RGB);
+    ping.allocate(width / divisor, height / divisor, GL_RGB);
+    pong.allocate(width / divisor, height / divisor, GL_RGB);
+}
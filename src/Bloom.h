@@ -0,0 +1,48 @@
+#pragma once
+
+#include "ofMain.h"
+
+/* Optional post-process glow. The scene is captured between |begin|
+ * and |end|, downsampled to a fraction of the window, blurred there
+ * with the separable 9-tap blur shaders in bin/data, and added back
+ * on top of the scene. Blurring at reduced resolution keeps the cost
+ * low and independent of how many objects are glowing. */
+class Bloom
+{
+public:
+    /* Resolution of the blur buffers relative to the window. */
+    enum Quality {
+        BLOOM_OFF,
+        BLOOM_QUARTER,
+        BLOOM_HALF
+    };
+    
+    Bloom();
+    
+    void setQuality(Quality quality);
+    Quality getQuality() const;
+    
+    /* True if quality is not |BLOOM_OFF| and the shaders loaded. */
+    bool isEnabled() const;
+    
+    /* Starts capturing the scene for a window of the given size. */
+    void begin(int width, int height);
+    
+    /* Stops capturing and draws the scene with bloom applied. */
+    void end();
+    
+private:
+    void load();
+    void allocate(int width, int height);
+    
+    Quality quality;
+    bool loaded;
+    int width, height;
+    
+    ofShader blurX, blurY;
+    
+    /* Full resolution scene, and the two low resolution buffers
+     * the blur passes ping-pong between. */
+    ofFbo scene;
+    ofFbo ping, pong;
+};
@@ -0,0 +1,61 @@
+#include "CachedText.h"
+
+CachedText::CachedText()
+: number(0), hasNumber(false), width(0), height(0) {
+    mesh.setUsage(GL_STATIC_DRAW);
+}
+
+void CachedText::set(std::shared_ptr<ofTrueTypeFont> font, const std::string& text) {
+    if (font == this->font && text == this->text) {
+        return;
+    }
+    this->font = font;
+    this->text = text;
+    hasNumber = false;
+    rebuild();
+}
+
+void CachedText::set(std::shared_ptr<ofTrueTypeFont> font, int number) {
+    if (font == this->font && hasNumber && number == this->number) {
+        return;
+    }
+    this->font = font;
+    this->text = ofToString(number);
+    this->number = number;
+    hasNumber = true;
+    rebuild();
+}
+
+float CachedText::getWidth() const {
+    return width;
+}
+
+float CachedText::getHeight() const {
+    return height;
+}
+
+void CachedText::draw(float x, float y) {
+    if (!font || text.empty()) {
+        return;
+    }
+    ofPushMatrix();
+    ofTranslate(x, y);
+    font->getFontTexture().bind();
+    mesh.draw();
+    font->getFontTexture().unbind();
+    ofPopMatrix();
+}
+
+void CachedText::rebuild() {
+    mesh.clear();
+    width = height = 0;
+    if (!font) {
+        return;
+    }
+    
+    // The font lays out glyphs into a mesh it reuses for every string,
+    // so copy it out. Build at the origin and translate when drawing.
+    mesh.append(font->getStringMesh(text, 0, 0));
+    width = font->stringWidth(text);
+    height = font->stringHeight(text);
+}
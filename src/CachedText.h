@@ -0,0 +1,43 @@
+#pragma once
+
+#include "ofMain.h"
+
+/* A string drawn with a given font whose glyph quads are laid out
+ * once and kept in a VBO mesh. The mesh, width and height are only
+ * rebuilt when the font or the text changes, so drawing text that
+ * rarely changes (counters, the score, titles) does no allocation
+ * or layout work per frame. */
+class CachedText
+{
+public:
+    CachedText();
+    
+    /* Sets the text. Does nothing if the text and font are unchanged. */
+    void set(std::shared_ptr<ofTrueTypeFont> font, const std::string& text);
+    
+    /* Sets the text to a number. Skips formatting entirely if the
+     * number and font are unchanged. */
+    void set(std::shared_ptr<ofTrueTypeFont> font, int number);
+    
+    /* Size of the text as measured by the font. */
+    float getWidth() const;
+    float getHeight() const;
+    
+    /* Draws the text with its baseline starting at (x, y), like
+     * |ofTrueTypeFont::drawString|. */
+    void draw(float x, float y);
+    
+private:
+    void rebuild();
+    
+    std::shared_ptr<ofTrueTypeFont> font;
+    std::string text;
+    
+    /* Last number passed to |set|, valid if |hasNumber|. */
+    int number;
+    bool hasNumber;
+    
+    float width;
+    float height;
+    ofVboMesh mesh;
+};
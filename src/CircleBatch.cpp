@@ -0,0 +1,40 @@
+#include "CircleBatch.h"
+
+CircleBatch::CircleBatch() {
+    mesh.setMode(OF_PRIMITIVE_TRIANGLES);
+    mesh.setUsage(GL_STREAM_DRAW);
+}
+
+void CircleBatch::clear() {
+    mesh.clear();
+    count = 0;
+}
+
+void CircleBatch::add(const ofVec2f& center, float radius, const ofColor& color) {
+    // Each circle is a fan around its center vertex.
+    int resolution = CircleTessellation::getSegments(radius);
+    const std::vector<ofVec2f>& unitCircle = CircleTessellation::getUnitCircle(resolution);
+    ofIndexType base = mesh.getNumVertices();
+    ofFloatColor vertexColor(color);
+    mesh.addVertex(ofVec3f(center.x, center.y, 0));
+    mesh.addColor(vertexColor);
+    for (int i = 0; i < resolution; i++) {
+        mesh.addVertex(ofVec3f(center.x + unitCircle[i].x * radius,
+                               center.y + unitCircle[i].y * radius, 0));
+        mesh.addColor(vertexColor);
+        mesh.addIndex(base);
+        mesh.addIndex(base + 1 + i);
+        mesh.addIndex(base + 1 + (i + 1) % resolution);
+    }
+    count++;
+}
+
+void CircleBatch::draw() {
+    if (count > 0) {
+        mesh.draw();
+    }
+}
+
+int CircleBatch::size() const {
+    return count;
+}
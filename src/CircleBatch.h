@@ -0,0 +1,32 @@
+#pragma once
+
+#include "ofMain.h"
+#include "CircleTessellation.h"
+
+/* Draws many filled circles with a single draw call. Circles are
+ * added each frame with their own position, radius and color and
+ * expanded into one persistent VBO mesh, which is uploaded once
+ * when the batch is drawn. The fixed-function renderer we use has
+ * no instancing, so instances are expanded on the CPU instead.
+ * Each circle gets as many segments as its radius needs. */
+class CircleBatch
+{
+public:
+    CircleBatch();
+    
+    /* Removes all circles. Keeps the allocated buffers. */
+    void clear();
+    
+    /* Adds a circle to the batch. */
+    void add(const ofVec2f& center, float radius, const ofColor& color);
+    
+    /* Draws all circles added since the last |clear|. */
+    void draw();
+    
+    /* Number of circles in the batch. */
+    int size() const;
+    
+private:
+    int count = 0;
+    ofVboMesh mesh;
+};
@@ -0,0 +1,56 @@
+#include "CircleTessellation.h"
+#include "Tunables.h"
+
+#define MIN_CIRCLE_SEGMENTS 8
+#define MAX_CIRCLE_SEGMENTS 128
+
+std::map<int, std::vector<ofVec2f> > CircleTessellation::unitCircles;
+std::map<int, ofVboMesh> CircleTessellation::disks;
+
+int CircleTessellation::getSegments(float radius) {
+    // Largest allowed distance, in pixels, between a circle and the
+    // midpoint of a segment approximating it.
+    float maxError = Tunables::get(Tunables::CIRCLE_ERROR);
+    if (radius <= maxError) {
+        return MIN_CIRCLE_SEGMENTS;
+    }
+    
+    // A segment spanning angle a deviates from the circle by
+    // r * (1 - cos(a / 2)), so solve for a at the allowed error.
+    float angle = 2 * acos(1 - maxError / radius);
+    int segments = (int)ceil(TWO_PI / angle);
+    segments = (segments + 3) / 4 * 4;
+    return ofClamp(segments, MIN_CIRCLE_SEGMENTS, MAX_CIRCLE_SEGMENTS);
+}
+
+const std::vector<ofVec2f>& CircleTessellation::getUnitCircle(int segments) {
+    std::vector<ofVec2f>& points = unitCircles[segments];
+    if (points.empty()) {
+        for (int i = 0; i < segments; i++) {
+            float angle = TWO_PI * i / segments;
+            points.push_back(ofVec2f(cos(angle), sin(angle)));
+        }
+    }
+    return points;
+}
+
+void CircleTessellation::drawCircle(float x, float y, float radius) {
+    int segments = getSegments(radius);
+    ofVboMesh& disk = disks[segments];
+    if (disk.getNumVertices() == 0) {
+        const std::vector<ofVec2f>& points = getUnitCircle(segments);
+        disk.setMode(OF_PRIMITIVE_TRIANGLE_FAN);
+        disk.setUsage(GL_STATIC_DRAW);
+        disk.addVertex(ofVec3f(0, 0, 0));
+        for (int i = 0; i <= segments; i++) {
+            const ofVec2f& point = points[i % segments];
+            disk.addVertex(ofVec3f(point.x, point.y, 0));
+        }
+    }
+    
+    ofPushMatrix();
+    ofTranslate(x, y, 0);
+    ofScale(radius, radius, 1);
+    disk.draw();
+    ofPopMatrix();
+}
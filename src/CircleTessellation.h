@@ -0,0 +1,27 @@
+#pragma once
+
+#include "ofMain.h"
+
+/* Picks how many segments to draw a circle with from its radius, so
+ * the polygon never strays more than the |Tunables::CIRCLE_ERROR|
+ * pixels from the true circle. Small particles get a handful of segments and
+ * large wave rings get more, instead of one resolution for all. */
+class CircleTessellation
+{
+public:
+    /* Segment count for a circle of |radius| screen pixels. Rounded
+     * up to a multiple of 4, so only a few unit circles are built. */
+    static int getSegments(float radius);
+    
+    /* Points on the unit circle for the given segment count. */
+    static const std::vector<ofVec2f>& getUnitCircle(int segments);
+    
+    /* Draws a filled circle in the current color, like |ofCircle|. */
+    static void drawCircle(float x, float y, float radius);
+    
+private:
+    static std::map<int, std::vector<ofVec2f> > unitCircles;
+    
+    /* Unit disks for |drawCircle|, by segment count. */
+    static std::map<int, ofVboMesh> disks;
+};
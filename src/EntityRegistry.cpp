@@ -0,0 +1,69 @@
+#include "EntityRegistry.h"
+
+#include <assert.h>
+
+EntityHandle EntityRegistry::add(EntityType type, int index) {
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else {
+        assert(slots.size() <= SLOT_MASK);
+        Slot fresh = { 1, NO_ENTITY, -1 };
+        slots.push_back(fresh);
+        slot = slots.size() - 1;
+    }
+    slots[slot].type = type;
+    slots[slot].index = index;
+    return slots[slot].generation << SLOT_BITS | slot;
+}
+
+void EntityRegistry::remove(EntityHandle handle) {
+    if (!find(handle)) {
+        return;
+    }
+    
+    // Skip generation zero, so no handle is ever |NULL_ENTITY|.
+    Slot& slot = slots[handle & SLOT_MASK];
+    slot.generation = slot.generation % MAX_GENERATION + 1;
+    slot.type = NO_ENTITY;
+    slot.index = -1;
+    freeSlots.push_back(handle & SLOT_MASK);
+}
+
+EntityType EntityRegistry::getType(EntityHandle handle) const {
+    const Slot* slot = find(handle);
+    return slot ? slot->type : NO_ENTITY;
+}
+
+int EntityRegistry::getIndex(EntityHandle handle) const {
+    const Slot* slot = find(handle);
+    return slot ? slot->index : -1;
+}
+
+void EntityRegistry::setIndex(EntityHandle handle, int index) {
+    if (find(handle)) {
+        slots[handle & SLOT_MASK].index = index;
+    }
+}
+
+int EntityRegistry::size() const {
+    return slots.size() - freeSlots.size();
+}
+
+void* EntityRegistry::toUserData(EntityHandle handle) {
+    return (void *)(uintptr_t)handle;
+}
+
+EntityHandle EntityRegistry::fromUserData(const void* data) {
+    return (EntityHandle)(uintptr_t)data;
+}
+
+const EntityRegistry::Slot* EntityRegistry::find(EntityHandle handle) const {
+    uint32_t slot = handle & SLOT_MASK;
+    if (slot >= slots.size() || slots[slot].generation != handle >> SLOT_BITS) {
+        return NULL;
+    }
+    return &slots[slot];
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/* Types of level objects. */
+enum EntityType {
+    NO_ENTITY,
+    PARTICLE_ENTITY,
+    SOUND_ENTITY,
+    SOURCE_ENTITY,
+    SINK_ENTITY,
+    BOX_ENTITY,
+    LINE_ENTITY,
+    ENTITY_TYPE_COUNT
+};
+
+/* Stable reference to a level object, made of a slot in the
+ * registry and the slot's generation. Removing the object bumps the
+ * generation, so old handles stop resolving even once the slot is
+ * reused. Handles are plain numbers, so they can be kept anywhere,
+ * including in physics bodies' user data, without dangling.
+ * |NULL_ENTITY| never resolves. */
+typedef uint32_t EntityHandle;
+#define NULL_ENTITY 0
+
+/* Maps handles to the type of their object and its position in the
+ * dense array of objects of that type, see |EntityArray|. Not thread
+ * safe. */
+class EntityRegistry
+{
+public:
+    /* Registers an object of |type| at |index| in its array. */
+    EntityHandle add(EntityType type, int index);
+    
+    /* Unregisters an object. Its handle goes stale. */
+    void remove(EntityHandle handle);
+    
+    /* Type of the object, or |NO_ENTITY| if the handle is stale. */
+    EntityType getType(EntityHandle handle) const;
+    
+    /* Position of the object in its array, or -1 if the handle is
+     * stale. */
+    int getIndex(EntityHandle handle) const;
+    
+    /* Records that the object has moved within its array. */
+    void setIndex(EntityHandle handle, int index);
+    
+    /* Number of live objects. */
+    int size() const;
+    
+    /* Handles as physics body user data, and back. */
+    static void* toUserData(EntityHandle handle);
+    static EntityHandle fromUserData(const void* data);
+
+private:
+    /* Bits of a handle holding the slot; the rest hold the
+     * generation, which is never zero in a valid handle. */
+    static const int SLOT_BITS = 20;
+    static const uint32_t SLOT_MASK = (1 << SLOT_BITS) - 1;
+    static const uint32_t MAX_GENERATION = (1 << (32 - SLOT_BITS)) - 1;
+    
+    struct Slot {
+        uint32_t generation;
+        EntityType type;
+        int index;
+    };
+    
+    /* The slot of |handle|, or NULL if the handle is stale. */
+    const Slot* find(EntityHandle handle) const;
+    
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+};
+
+/* Dense array of the level objects of one type, with each object's
+ * handle alongside. Removing an object moves the last one into its
+ * place, so the array stays packed for iteration while handles keep
+ * finding the objects. */
+template <class T>
+class EntityArray
+{
+public:
+    EntityArray(EntityRegistry& registry, EntityType type)
+    : registry(registry), type(type) {
+    }
+    
+    int size() const {
+        return objects.size();
+    }
+    
+    T* operator[](int index) const {
+        return objects[index];
+    }
+    
+    EntityHandle getHandle(int index) const {
+        return handles[index];
+    }
+    
+    /* The object of |handle|, or NULL if the handle is stale or is
+     * for another type. */
+    T* get(EntityHandle handle) const {
+        if (registry.getType(handle) != type) {
+            return NULL;
+        }
+        return objects[registry.getIndex(handle)];
+    }
+    
+    /* Appends an object and returns its new handle. */
+    EntityHandle add(T* object) {
+        objects.push_back(object);
+        handles.push_back(registry.add(type, objects.size() - 1));
+        return handles.back();
+    }
+    
+    /* Replaces the object at |index|, keeping its place in the array.
+     * The old object's handle goes stale. Returns the new handle. */
+    EntityHandle replace(int index, T* object) {
+        registry.remove(handles[index]);
+        objects[index] = object;
+        handles[index] = registry.add(type, index);
+        return handles[index];
+    }
+    
+    /* Removes the object at |index| and returns it, moving the last
+     * object into its place. */
+    T* remove(int index) {
+        T* object = objects[index];
+        registry.remove(handles[index]);
+        if (index != objects.size() - 1) {
+            objects[index] = objects.back();
+            handles[index] = handles.back();
+            registry.setIndex(handles[index], index);
+        }
+        objects.pop_back();
+        handles.pop_back();
+        return object;
+    }
+    
+    /* Removes all objects. */
+    void clear() {
+        for (int i = 0; i < handles.size(); i++) {
+            registry.remove(handles[i]);
+        }
+        objects.clear();
+        handles.clear();
+    }
+
+private:
+    EntityRegistry& registry;
+    EntityType type;
+    std::vector<T*> objects;
+    std::vector<EntityHandle> handles;
+};
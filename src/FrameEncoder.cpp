@@ -0,0 +1,121 @@
+#include "FrameEncoder.h"
+
+/* Queued frames per worker before |add| waits. */
+#define FRAMES_PER_WORKER 2
+
+FrameEncoder::FrameEncoder() {
+}
+
+FrameEncoder::~FrameEncoder() {
+    finish();
+}
+
+void FrameEncoder::start(int workers) {
+    finish();
+    for (int i = 0; i < workers; i++) {
+        this->workers.push_back(new Worker(*this));
+        this->workers.back()->startThread(true, false);
+    }
+}
+
+void FrameEncoder::add(ofPixels& pixels, const std::string path, bool flip) {
+    // Wait for room in the queue.
+    int capacity = FRAMES_PER_WORKER * std::max((int)workers.size(), 1);
+    mutex.lock();
+    while (queue.size() >= capacity) {
+        mutex.unlock();
+        ofSleepMillis(1);
+        mutex.lock();
+    }
+    
+    queue.push_back(Job());
+    Job& job = queue.back();
+    job.path = path;
+    job.flip = flip;
+    job.pixels.swap(pixels);
+    if (!spare.empty()) {
+        pixels.swap(spare.back());
+        spare.pop_back();
+    }
+    mutex.unlock();
+    
+    // Without workers, encode right away.
+    if (workers.empty()) {
+        Job job;
+        if (next(job)) {
+            encode(job);
+            done(job);
+        }
+    }
+}
+
+void FrameEncoder::finish() {
+    // Let the workers drain the queue before stopping them.
+    mutex.lock();
+    while (!workers.empty() && (!queue.empty() || busy > 0)) {
+        mutex.unlock();
+        ofSleepMillis(1);
+        mutex.lock();
+    }
+    mutex.unlock();
+    
+    for (int i = 0; i < workers.size(); i++) {
+        workers[i]->waitForThread(true);
+        delete workers[i];
+    }
+    workers.clear();
+}
+
+int FrameEncoder::getSavedCount() {
+    mutex.lock();
+    int count = saved;
+    mutex.unlock();
+    return count;
+}
+
+bool FrameEncoder::next(Job& job) {
+    bool found = false;
+    mutex.lock();
+    if (!queue.empty()) {
+        job.path = queue.front().path;
+        job.flip = queue.front().flip;
+        job.pixels.swap(queue.front().pixels);
+        queue.pop_front();
+        busy++;
+        found = true;
+    }
+    mutex.unlock();
+    return found;
+}
+
+void FrameEncoder::encode(Job& job) {
+    if (job.flip) {
+        job.pixels.mirror(true, false);
+    }
+    ofSaveImage(job.pixels, job.path);
+}
+
+void FrameEncoder::done(Job& job) {
+    mutex.lock();
+    spare.push_back(ofPixels());
+    spare.back().swap(job.pixels);
+    busy--;
+    saved++;
+    mutex.unlock();
+}
+
+FrameEncoder::Worker::Worker(FrameEncoder& encoder)
+: encoder(encoder) {
+}
+
+void FrameEncoder::Worker::threadedFunction() {
+    while (isThreadRunning()) {
+        Job job;
+        if (!encoder.next(job)) {
+            sleep(1);
+            continue;
+        }
+        encode(job);
+        encoder.done(job);
+    }
+}
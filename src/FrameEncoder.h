@@ -0,0 +1,69 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include <deque>
+
+/* Saves rendered frames as PNG files on a pool of worker threads.
+ * PNG compression is much slower than rendering a frame, so frames
+ * are queued and compressed in parallel while the next ones render.
+ * The queue is bounded: |add| waits for a worker when it is full, so
+ * memory stays flat and rendering runs as fast as encoding allows. */
+class FrameEncoder
+{
+public:
+    FrameEncoder();
+    ~FrameEncoder();
+    
+    /* Starts |workers| encoding threads. */
+    void start(int workers);
+    
+    /* Queues |pixels| to be saved at the given absolute path,
+     * flipped vertically first if |flip| is set. The pixels are
+     * swapped with a recycled buffer, so callers can read the next
+     * frame into |pixels| without allocating. */
+    void add(ofPixels& pixels, const std::string path, bool flip = false);
+    
+    /* Waits for all queued frames to be saved and stops the workers. */
+    void finish();
+    
+    /* Number of frames saved so far. */
+    int getSavedCount();
+    
+private:
+    struct Job {
+        ofPixels pixels;
+        std::string path;
+        bool flip;
+    };
+    
+    class Worker : public ofThread
+    {
+    public:
+        Worker(FrameEncoder& encoder);
+        
+    protected:
+        void threadedFunction();
+        
+    private:
+        FrameEncoder& encoder;
+    };
+    
+    /* Moves the next job into |job|. Returns false if there is none. */
+    bool next(Job& job);
+    
+    /* Saves the frame of |job|. */
+    static void encode(Job& job);
+    
+    /* Returns the buffer of a finished job for reuse. */
+    void done(Job& job);
+    
+    std::vector<Worker*> workers;
+    
+    /* Shared with the workers; guarded by |mutex|. */
+    ofMutex mutex;
+    std::deque<Job> queue;
+    std::deque<ofPixels> spare;
+    int busy = 0;
+    int saved = 0;
+};
@@ -0,0 +1,15 @@
+#include "GameClock.h"
+
+float GameClock::time = 0;
+
+float GameClock::getTime() {
+    return time;
+}
+
+void GameClock::update() {
+    time = ofGetElapsedTimef();
+}
+
+void GameClock::setTime(float time) {
+    GameClock::time = time;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "ofMain.h"
+
+/* Time as seen by game logic: particle emission, sink previews and
+ * wave animation. It only moves once per update, so everything in a
+ * frame agrees on the time, and it can be driven from a recorded
+ * session instead of the wall clock so replays come out the same. */
+class GameClock
+{
+public:
+    /* Seconds since the app started, as of the last |update| or
+     * |setTime|. */
+    static float getTime();
+    
+    /* Advances to the current wall clock time. */
+    static void update();
+    
+    /* Sets the time directly, e.g. from a recorded session. */
+    static void setTime(float time);
+    
+private:
+    static float time;
+};
@@ -1,13 +1,42 @@
 #include "Level.h"
+#include "Allocations.h"
+#include "AssetCache.h"
+#include "GameClock.h"
+#include "Trace.h"
+#include "Telemetry.h"
+#include "Tunables.h"
+
+#include <float.h>
+
+/* Relative speed, in meters per second, at which a contact rings
+ * at full strength. */
+#define FULL_STRIKE_SPEED 10.f
+
+/* Contacts weaker than this, like grazes, stay silent. */
+#define MIN_STRIKE_STRENGTH 0.05f
+
+/* Seconds each sink sounds in the preview melody, and its volume,
+ * as loud as a held |ofSoundMixer::Play|. */
+#define PREVIEW_NOTE_LENGTH 1.f
+#define PREVIEW_VOLUME 0.2f
 
 ofxBox2d* Level::box2d = NULL;
 ofSoundMixer* Level::sm = NULL;
-ofTrueTypeFont Level::font;
+unsigned int Level::revisionCounter = 0;
+bool Level::trailsEnabled = false;
+WaveField* Level::waveField = NULL;
+int Level::windowWidth = 0;
+int Level::windowHeight = 0;
 
-const static string BOX("box");
-const static string SOUND("sound");
-const static string SOURCE("source");
-const static string SINK("sink");
+const ResonatorMaterial Level::contactMaterials[ENTITY_TYPE_COUNT] = {
+    BOX_MATERIAL,       // NO_ENTITY
+    PARTICLE_MATERIAL,  // PARTICLE_ENTITY
+    BOX_MATERIAL,       // SOUND_ENTITY
+    BOX_MATERIAL,       // SOURCE_ENTITY
+    BOX_MATERIAL,       // SINK_ENTITY
+    BOX_MATERIAL,       // BOX_ENTITY
+    LINE_MATERIAL       // LINE_ENTITY
+};
 
 void Level::Initialize(ofxBox2d* b2d, ofSoundMixer* mixer) {
     box2d = b2d;
@@ -15,16 +44,16 @@ void Level::Initialize(ofxBox2d* b2d, ofSoundMixer* mixer) {
 }
 
 Level::Level(const std::string filename) {
+    invalidateStatic();
+    
     // Sanity check that box2d has been initialized.
     if (!box2d) {
         std::cerr << "Level::Initialize function must be invoked before creating levels!" << std::endl;
         return;
     }
     
-    // Load shared font if it hasn't been loaded.
-    if (!font.isLoaded()) {
-        font.loadFont("Kiddish.ttf", 40, true, true);
-    }
+    // Fetch shared font.
+    font = AssetCache::getFont("Kiddish.ttf", 40);
     
     // Load level from filename.
     if (!filename.empty()) {
@@ -36,73 +65,247 @@ Level::Level(const std::string filename) {
     ofAddListener(box2d->contactEndEvents, this, &Level::onContactEnd);
 }
 
+Level::Level(const LevelDescription& description)
+: Level() {
+    loadFromDescription(description);
+}
+
+Level::Level(const LevelPack& pack, int index)
+: Level() {
+    loadFromPack(pack, index);
+}
+
 Level::~Level() {
+    if (box2d) {
+        ofRemoveListener(box2d->contactStartEvents, this, &Level::onContactStart);
+        ofRemoveListener(box2d->contactEndEvents, this, &Level::onContactEnd);
+    }
+    if (previewSequence != -1) {
+        sm->RemoveSequence(previewSequence);
+    }
     selectionMutex.lock();
     boxes.clear();
     particles.clear();
     circles.clear();
+    sources.clear();
+    sinks.clear();
+    lines.clear();
+    
+    // Destroy all level objects at once.
+    arena.release();
     selectionMutex.unlock();
 }
 
+void Level::setTrailsEnabled(bool enabled) {
+    trailsEnabled = enabled;
+}
+
+bool Level::getTrailsEnabled() {
+    return trailsEnabled;
+}
+
+void Level::setWaveField(WaveField* field) {
+    waveField = field;
+}
+
+void Level::setWindowSize(int width, int height) {
+    windowWidth = width;
+    windowHeight = height;
+}
+
+int Level::getWindowWidth() {
+    return windowWidth > 0 ? windowWidth : ofGetWidth();
+}
+
+int Level::getWindowHeight() {
+    return windowHeight > 0 ? windowHeight : ofGetHeight();
+}
+
 void Level::loadFromFile(const std::string filename) {
+    TRACE_SCOPE("Level::loadFromFile");
+    AllocationScope allocationScope(Allocations::LEVEL_LOAD);
     // Open file.
     std::string currentDirectory = ofDirectory().getAbsolutePath();
     std::string absolutePath = currentDirectory + filename;
-    std::ifstream infile(absolutePath.c_str());
-    std::string line;
+    LevelDescription description;
+    if (description.loadFromFile(absolutePath)) {
+        loadFromDescription(description);
+    }
+}
+
+void Level::loadFromDescription(const LevelDescription& description) {
+    TRACE_SCOPE("Level::loadFromDescription");
+    AllocationScope allocationScope(Allocations::LEVEL_LOAD);
+    title = description.title;
     
-    // Get title
-    getline(infile, line);
-    title = line;
+    for (int i = 0; i < description.boxes.size(); i++) {
+        const BoxDescription& box = description.boxes[i];
+        addEntity(boxes, createBox(box.x, box.y, box.width, box.height));
+    }
+    for (int i = 0; i < description.sounds.size(); i++) {
+        const SoundDescription& sound = description.sounds[i];
+        addEntity(circles, createSound(sound.x, sound.y, sound.freq));
+    }
+    for (int i = 0; i < description.sources.size(); i++) {
+        const SourceDescription& source = description.sources[i];
+        addEntity(sources, createSource(source.x, source.y, source.pattern));
+    }
+    for (int i = 0; i < description.sinks.size(); i++) {
+        const SinkDescription& sink = description.sinks[i];
+        addEntity(sinks, createSink(sink.x, sink.y, sink.freq, sink.limit));
+    }
+}
+
+void Level::loadFromPack(const LevelPack& pack, int index) {
+    TRACE_SCOPE("Level::loadFromPack");
+    AllocationScope allocationScope(Allocations::LEVEL_LOAD);
+    const LevelPackLevel* level = pack.getLevel(index);
+    if (!level) {
+        std::cerr << "Level " << index << " is missing from the level pack!" << std::endl;
+        return;
+    }
+    title = pack.getTitle(*level);
     
-    while (getline(infile, line)) {
-        // Skip empty lines and comment lines.
-        if (line.empty() || line[0] == '#') {
-            continue;
+    // Records are read straight out of the mapped pack.
+    const LevelPackBox* packBoxes = pack.getBoxes(*level);
+    for (int i = 0; i < level->boxCount; i++) {
+        addEntity(boxes, createBox(packBoxes[i].x, packBoxes[i].y, packBoxes[i].width, packBoxes[i].height));
+    }
+    const LevelPackSound* packSounds = pack.getSounds(*level);
+    for (int i = 0; i < level->soundCount; i++) {
+        addEntity(circles, createSound(packSounds[i].x, packSounds[i].y, packSounds[i].freq));
+    }
+    const LevelPackSource* packSources = pack.getSources(*level);
+    for (int i = 0; i < level->sourceCount; i++) {
+        const int32_t* notes = pack.getNotes(packSources[i]);
+        if (notes) {
+            std::vector<int> pattern(notes, notes + packSources[i].noteCount);
+            addEntity(sources, createSource(packSources[i].x, packSources[i].y, pattern));
         }
-        
-        // Fetch line prefix.
-        std::istringstream ss(line);
-        std::string prefix;
-        ss >> prefix;
-        
-        // Add objects according to instruction from prefix.
-        if (prefix == BOX) {
-            float x, y, width, height;
-            ss >> x >> y >> width >> height;
-            boxes.push_back(std::shared_ptr<ofxBox2dRect>(new ofxBox2dRect()));
-            boxes.back().get()->setup(box2d->getWorld(), x, y, width, height);
+    }
+    const LevelPackSink* packSinks = pack.getSinks(*level);
+    for (int i = 0; i < level->sinkCount; i++) {
+        addEntity(sinks, createSink(packSinks[i].x, packSinks[i].y, packSinks[i].freq, packSinks[i].limit));
+    }
+}
+
+ofxBox2dRect* Level::createBox(float x, float y, float width, float height) {
+    ofxBox2dRect* box = arena.create<ofxBox2dRect>();
+    box->setup(box2d->getWorld(), x, y, width, height);
+    return box;
+}
+
+SoundSource* Level::createSound(float x, float y, float freq) {
+    SoundSource* circle = arena.create<SoundSource>(freq);
+    circle->setup(box2d->getWorld(), x, y, 10);
+    return circle;
+}
+
+ParticleSource* Level::createSource(float x, float y, const std::vector<int>& pattern) {
+    ParticleSource* source = arena.create<ParticleSource>(pattern);
+    source->setup(box2d->getWorld(), x, y, 0);
+    return source;
+}
+
+ParticleSink* Level::createSink(float x, float y, float freq, int limit) {
+    ParticleSink* sink = arena.create<ParticleSink>(limit, freq);
+    sink->setup(box2d->getWorld(), x, y, 0);
+    return sink;
+}
+
+void Level::applyChanges(const LevelDescription& before, const LevelDescription& after) {
+    selectionMutex.lock();
+    
+    title = after.title;
+    bool sinksChanged = sinks.size() != after.sinks.size();
+    
+    // Objects are matched up by their order in the file. Bodies
+    // are only recreated if a property they were built with has
+    // changed; moves and limit changes are applied in place.
+    for (int i = 0; i < boxes.size() && i < after.boxes.size(); i++) {
+        const BoxDescription& box = after.boxes[i];
+        if (i < before.boxes.size() &&
+            box.width == before.boxes[i].width && box.height == before.boxes[i].height) {
+            if (box.x != before.boxes[i].x || box.y != before.boxes[i].y) {
+                boxes[i]->setPosition(box.x, box.y);
+            }
         }
-        else if (prefix == SOUND) {
-            float x, y, freq;
-            ss >> x >> y >> freq;
-            circles.push_back(std::shared_ptr<SoundSource>(new SoundSource(freq)));
-            circles.back().get()->setup(box2d->getWorld(), x, y, 10);
+        else {
+            replaceEntity(boxes, i, createBox(box.x, box.y, box.width, box.height));
         }
-        else if (prefix == SOURCE) {
-            float x, y, freq;
-            std::vector<int> emmissionPattern;
-            ss >> x >> y;
-            while (ss >> freq) {
-                emmissionPattern.push_back(freq);
+    }
+    for (int i = 0; i < circles.size() && i < after.sounds.size(); i++) {
+        const SoundDescription& sound = after.sounds[i];
+        if (i < before.sounds.size() && sound.freq == before.sounds[i].freq) {
+            if (sound.x != before.sounds[i].x || sound.y != before.sounds[i].y) {
+                circles[i]->setPosition(sound.x, sound.y);
             }
-            sources.push_back(std::shared_ptr<ParticleSource>(new ParticleSource(emmissionPattern)));
-            sources.back().get()->setup(box2d->getWorld(), x, y, 0);
         }
-        else if (prefix == SINK) {
-            int limit;
-            float x, y, freq;
-            ss >> x >> y >> freq >> limit;
-            sinks.push_back(std::shared_ptr<ParticleSink>(new ParticleSink(limit, freq)));
-            sinks.back().get()->setup(box2d->getWorld(), x, y, 0);
-            sinks.back().get()->play();
+        else {
+            replaceEntity(circles, i, createSound(sound.x, sound.y, sound.freq));
         }
     }
+    for (int i = 0; i < sources.size() && i < after.sources.size(); i++) {
+        const SourceDescription& source = after.sources[i];
+        if (i >= before.sources.size() || source.x != before.sources[i].x || source.y != before.sources[i].y) {
+            sources[i]->setPosition(source.x, source.y);
+        }
+        if (i >= before.sources.size() || source.pattern != before.sources[i].pattern) {
+            sources[i]->setPattern(source.pattern);
+        }
+    }
+    for (int i = 0; i < sinks.size() && i < after.sinks.size(); i++) {
+        const SinkDescription& sink = after.sinks[i];
+        if (i < before.sinks.size() && sink.freq == before.sinks[i].freq) {
+            if (sink.x != before.sinks[i].x || sink.y != before.sinks[i].y) {
+                sinks[i]->setPosition(sink.x, sink.y);
+            }
+            if (sink.limit != before.sinks[i].limit) {
+                sinks[i]->setLimit(sink.limit);
+            }
+        }
+        else {
+            replaceEntity(sinks, i, createSink(sink.x, sink.y, sink.freq, sink.limit));
+            sinksChanged = true;
+        }
+    }
+    
+    // Drop objects removed from the end of the file...
+    truncate(boxes, after.boxes.size());
+    truncate(circles, after.sounds.size());
+    truncate(sources, after.sources.size());
+    truncate(sinks, after.sinks.size());
+    
+    // ...and create the ones added to it.
+    for (int i = boxes.size(); i < after.boxes.size(); i++) {
+        const BoxDescription& box = after.boxes[i];
+        addEntity(boxes, createBox(box.x, box.y, box.width, box.height));
+    }
+    for (int i = circles.size(); i < after.sounds.size(); i++) {
+        const SoundDescription& sound = after.sounds[i];
+        addEntity(circles, createSound(sound.x, sound.y, sound.freq));
+    }
+    for (int i = sources.size(); i < after.sources.size(); i++) {
+        const SourceDescription& source = after.sources[i];
+        addEntity(sources, createSource(source.x, source.y, source.pattern));
+    }
+    for (int i = sinks.size(); i < after.sinks.size(); i++) {
+        const SinkDescription& sink = after.sinks[i];
+        addEntity(sinks, createSink(sink.x, sink.y, sink.freq, sink.limit));
+    }
+    
+    // The preview melody plays the voices of the old sinks.
+    if (sinksChanged && previewSequence != -1) {
+        startPreview();
+    }
+    
+    invalidateStatic();
+    selectionMutex.unlock();
 }
 
 bool Level::complete() {
     for (int i = 0; i < sinks.size(); i++) {
-        if (!sinks[i].get()->isFull()) {
+        if (!sinks[i]->isFull()) {
             return false;
         }
     }
@@ -113,129 +316,288 @@ int Level::getLineCount() {
     return lines.size();
 }
 
+int Level::getParticleCount() {
+    return particles.size();
+}
+
 void Level::update() {
+    TRACE_SCOPE("Level::update");
+    AllocationScope allocationScope(Allocations::LEVEL_UPDATE);
+    
     // Log start time.
     if (startTime == -1.f) {
-        startTime = ofGetElapsedTimef();
+        startTime = GameClock::getTime();
     }
     
-    // Play preview sounds from sinks.
+    updatePreviews();
+    emitParticles();
+    updateParticles();
+}
+
+void Level::updatePreviews() {
+    TRACE_SCOPE("Level::updatePreviews");
+    if (previewSequence == -1) {
+        startPreview();
+    }
+    
+    // The mixer plays the melody. Show the waves of the sink that
+    // is sounding, going by game time so recordings replay exactly.
+    float elapsed = GameClock::getTime() - previewStartTime;
     for (int i = 0; i < sinks.size(); i++) {
-        ParticleSink* sink = sinks[i].get();
-        float now = ofGetElapsedTimef();
-        if (now - startTime > i && now - startTime < i + 1) {
-            sink->play();
-        }
-        else {
-            sink->stop();
+        bool playing = elapsed > i * PREVIEW_NOTE_LENGTH && elapsed < (i + 1) * PREVIEW_NOTE_LENGTH;
+        sinks[i]->setPlaying(playing);
+        if (playing && waveField) {
+            waveField->addEmitter(sinks[i]->getPosition(), sinks[i]->getFrequency(), 1);
         }
     }
+}
+
+void Level::startPreview() {
+    if (previewSequence != -1) {
+        sm->RemoveSequence(previewSequence);
+    }
+    
+    // Play each sink's pitch in turn, once.
+    int noteLength = PREVIEW_NOTE_LENGTH * sm->GetSampleRate();
+    std::vector<SequenceNote> notes;
+    for (int i = 0; i < sinks.size(); i++) {
+        SequenceNote note = { (int64_t)i * noteLength, noteLength, sinks[i]->getSoundSourceID(), PREVIEW_VOLUME };
+        notes.push_back(note);
+    }
+    previewSequence = sm->AddSequence(Sequence(notes, (int64_t)sinks.size() * noteLength, false));
+    previewStartTime = GameClock::getTime();
+}
+
+void Level::emitParticles() {
+    TRACE_SCOPE("Level::emitParticles");
     
     // Add new particles.
     for (int i = 0; i < sources.size(); i++) {
-        ParticleSource* source = sources[i].get();
+        ParticleSource* source = sources[i];
         if (source && source->shouldEmitParticle()) {
-            float r = 10;
-            particles.push_back(std::shared_ptr<SoundParticle>(new SoundParticle(source->getFrequency())));
-            particles.back().get()->setPhysics(3.0, 0.53, 0.1);
-            particles.back().get()->setup(box2d->getWorld(), source->getPosition().x, source->getPosition().y, r);
+            addParticle(source->getPosition().x, source->getPosition().y, source->getFrequency());
         }
     }
+}
+
+float Level::getNextEmissionTime() {
+    float time = FLT_MAX;
+    for (int i = 0; i < sources.size(); i++) {
+        time = min(time, sources[i]->getNextEmissionTime());
+    }
+    return time;
+}
+
+void Level::addParticle(float x, float y, float frequency) {
+    float r = Tunables::get(Tunables::PARTICLE_RADIUS);
+    SoundParticle* particle = arena.create<SoundParticle>(frequency);
+    particle->setPhysics(3.0, 0.53, 0.1);
+    particle->setup(box2d->getWorld(), x, y, r);
+    addEntity(particles, particle);
+}
+
+void Level::updateParticles() {
+    TRACE_SCOPE("Level::updateParticles");
+    
+    // Drop the trails if they were just disabled.
+    if (!trailsEnabled && trails.size() > 0) {
+        trails.clear();
+        for (int i = 0; i < particles.size(); i++) {
+            particles[i]->setTrail(-1);
+        }
+    }
+    
+    // Gather the circles once for the tests below.
+    circlePositions.resize(circles.size());
+    circleFrequencies.resize(circles.size());
+    for (int j = 0; j < circles.size(); j++) {
+        circlePositions[j] = circles[j]->getPosition();
+        circleFrequencies[j] = circles[j]->getFrequency();
+    }
     
     // Update all dynamic objects.
     for (int i = 0; i < particles.size(); i++) {
-        SoundParticle& particle = *particles[i].get();
+        SoundParticle& particle = *particles[i];
         particle.update();
         
         // Delete off-screen particles
         ofVec2f position = particle.getPosition();
-        if (position.x < 0 || position.x > ofGetWidth() ||
-            position.y > ofGetHeight() + 30) {
-            particles.erase(particles.begin() + i);
+        if (position.x < 0 || position.x > getWindowWidth() ||
+            position.y > getWindowHeight() + 30) {
+            removeParticle(i);
             i--;
+            continue;
+        }
+        
+        // Extend the trail, starting one if trails were just enabled.
+        if (trailsEnabled) {
+            if (particle.getTrail() == -1) {
+                particle.setTrail(trails.acquire());
+            }
+            trails.add(particle.getTrail(), position);
         }
         
-        // Repel particles
-        std::vector<std::shared_ptr<SoundSource> > repellants;
+        // Repel particles, unless they are caught between two
+        // sound sources.
+        SoundSource* repellant = NULL;
+        int repellantCount = 0;
+        Telemetry::add(Telemetry::REPEL_TESTS, circles.size());
         for (int j = 0; j < circles.size(); j++) {
-            if (circles[j].get()->shouldRepel(particle)) {
-                repellants.push_back(circles[j]);
+            if (SoundSource::shouldRepel(circlePositions[j], circleFrequencies[j], position, particle.getFrequency())) {
+                repellant = circles[j];
+                repellantCount++;
             }
         }
-        if (repellants.size() < 2) {
-            for (int j = 0; j < repellants.size(); j++) {
-                 repellants[j].get()->repel(particle);
+        if (repellantCount == 1) {
+            float volume = repellant->repel(particle);
+            if (waveField) {
+                waveField->addEmitter(repellant->getPosition(), repellant->getFrequency(), volume);
             }
         }
         
         // Add attraction force from sinks.
         for (int j = 0; j < sinks.size(); j++) {
-            ParticleSink* sink = sinks[j].get();
+            ParticleSink* sink = sinks[j];
+            Telemetry::add(Telemetry::ATTRACT_TESTS);
             if (sink && sink->attract(particle)) {
-                particles.erase(particles.begin() + i);
+                removeParticle(i);
                 i--;
+                break;
             }
         }
     }
+    
+    Telemetry::set(Telemetry::PARTICLES, particles.size());
+}
+
+void Level::removeParticle(int index) {
+    trails.release(particles[index]->getTrail());
+    arena.destroy(particles.remove(index));
 }
 
 void Level::draw(bool highlightsOnly) {
-    // Draw objects.
+    drawDynamic();
+    drawStatic();
+}
+
+void Level::drawDynamic() {
+    // Draw sink waves below everything else.
+    drawWaves();
+    drawObjects();
+}
+
+void Level::drawWaves() {
+    TRACE_SCOPE("Level::drawWaves");
+    AllocationScope allocationScope(Allocations::LEVEL_DRAW);
     for (int i = 0; i < sinks.size(); i++) {
-        float freq = sinks[i].get()->getFrequency() - 220;
-        // range is 220 - 880
-        float red = ((660.f - freq) / 660.f) * 255;
-        float blue = (freq / 660.0f) * 255;
-        sinks[i].get()->draw(ofColor(red, 0, blue, 255));
+        sinks[i]->drawWaves(getFrequencyColor(sinks[i]->getFrequency()));
+    }
+}
+
+void Level::drawObjects() {
+    AllocationScope allocationScope(Allocations::LEVEL_DRAW);
+    drawEmitters();
+    drawSounds();
+    drawParticles();
+    
+    // Draw the line being drawn.
+    ofSetColor(255, 255, 255);
+    if (currentLine) {
+        currentLine->draw();
+    }
+}
+
+void Level::drawEmitters() {
+    TRACE_SCOPE("Level::drawEmitters");
+    
+    // Draw sink and source bodies in one batch, then the sink counts
+    // on top of them.
+    emitterBatch.clear();
+    for (int i = 0; i < sinks.size(); i++) {
+        sinks[i]->addToBatch(emitterBatch, getFrequencyColor(sinks[i]->getFrequency()));
     }
     for (int i = 0; i < sources.size(); i++) {
-        ofSetColor(0, 255, 0);
-        sources[i].get()->draw();
+        sources[i]->addToBatch(emitterBatch, ofColor(0, 255, 0));
+    }
+    emitterBatch.draw();
+    for (int i = 0; i < sinks.size(); i++) {
+        sinks[i]->drawCount();
     }
+}
+
+void Level::drawSounds() {
+    TRACE_SCOPE("Level::drawSounds");
     for (int i = 0; i < circles.size(); i++) {
-        float freq = circles[i].get()->getFrequency() - 220;
-        // range is 220 - 880
-        float red = ((660.f - freq) / 660.f) * 255;
-        float blue = (freq / 660.0f) * 255;
-        circles[i].get()->draw(ofColor(red, 0, blue, 255));
+        circles[i]->draw(getFrequencyColor(circles[i]->getFrequency()));
+    }
+}
+
+void Level::drawParticles() {
+    TRACE_SCOPE("Level::drawParticles");
+    if (trailsEnabled) {
+        trails.draw(ofColor(255, 255, 255, 128));
     }
+    particleBatch.clear();
     for (int i = 0; i < particles.size(); i++) {
-        ofSetColor(255, 255, 255);
-        particles[i].get()->draw();
+        particles[i]->addToBatch(particleBatch, ofColor(255, 255, 255));
     }
+    particleBatch.draw();
+}
+
+void Level::drawStatic() {
+    TRACE_SCOPE("Level::drawStatic");
+    AllocationScope allocationScope(Allocations::LEVEL_DRAW);
+    
+    // Draw boxes.
     for (int i = 0; i < boxes.size(); i++) {
         ofSetColor(0, 0, 102);
-        boxes[i].get()->draw();
+        boxes[i]->draw();
         ofPushStyle();
         ofNoFill();
         ofSetColor(0, 0, 255);
-        boxes[i].get()->draw();
+        boxes[i]->draw();
         ofPopStyle();
     }
     
     // Draw lines.
     ofSetColor(255, 255, 255);
-    if (currentLine) {
-        currentLine->draw();
-    }
     for (int i = 0; i < lines.size(); i++) {
-        lines[i].get()->draw();
+        lines[i]->draw();
     }
     
     // Draw level title.
     ofSetColor(255, 255, 255, 255);
-    int width = font.stringWidth(title);
-    font.drawString(title, ofGetWidth() / 2.f - width / 2.f, 60);
+    titleText.set(font, title);
+    titleText.draw(getWindowWidth() / 2.f - titleText.getWidth() / 2.f, 60);
+}
+
+unsigned int Level::getStaticRevision() {
+    return staticRevision;
+}
+
+void Level::invalidateStatic() {
+    staticRevision = ++revisionCounter;
+}
+
+ofColor Level::getFrequencyColor(float frequency) {
+    float freq = frequency - 220;
+    // range is 220 - 880
+    float red = ((660.f - freq) / 660.f) * 255;
+    float blue = (freq / 660.0f) * 255;
+    return ofColor(red, 0, blue, 255);
 }
 
 void Level::keyPressed(int key) {
     if (key == 'r' || key == 'R') {
-        particles.clear();
-        lines.clear();
+        truncate(particles, 0);
+        trails.clear();
+        truncate(lines, 0);
+        invalidateStatic();
     }
     else if (key == 'u' || key == 'U') {
         if (lines.size() > 0) {
-            lines.erase(lines.end());
+            truncate(lines, lines.size() - 1);
+            invalidateStatic();
         }
     }
 }
@@ -247,10 +609,12 @@ void Level::mouseMoved(int x, int y) {
 
 void Level::mouseDragged(ofMouseEventArgs &e) {
     selectionMutex.lock();
+    b2Body* selectedBody = getBody(selected);
     if (selectedBody) {
         // If there is a body being dragged, update its position.
         b2Vec2 position(e.x/OFX_BOX2D_SCALE, e.y/OFX_BOX2D_SCALE);
         selectedBody->SetTransform(position, 0);
+        invalidateStatic();
     }
     if (currentLine) {
         // If there is a line being drawn, add a key point at the mouse
@@ -283,7 +647,7 @@ void Level::mousePressed(ofMouseEventArgs &e) {
     box2d->world->QueryAABB(&callback, aabb);
     if (callback.m_fixture) {
         // If there's a hit, set the hit body as the drag body.
-        selectedBody = callback.m_fixture->GetBody();
+        selected = EntityRegistry::fromUserData(callback.m_fixture->GetBody()->GetUserData());
     }
     else {
         // Create a new line.
@@ -295,17 +659,31 @@ void Level::mousePressed(ofMouseEventArgs &e) {
 
 void Level::mouseReleased(ofMouseEventArgs &e) {
     selectionMutex.lock();
-    selectedBody = NULL;
+    selected = NULL_ENTITY;
     if (currentLine) {
-        std::shared_ptr<ofxBox2dEdge> edge(edgeFromPolyline(currentLine.get()));
-        lines.push_back(edge);
+        addEntity(lines, edgeFromPolyline(currentLine.get()));
+        invalidateStatic();
         currentLine.reset();
     }
     selectionMutex.unlock();
 }
 
+b2Body* Level::getBody(EntityHandle handle) {
+    ofxBox2dBaseShape* object = NULL;
+    switch (registry.getType(handle)) {
+        case PARTICLE_ENTITY: object = particles.get(handle); break;
+        case SOUND_ENTITY: object = circles.get(handle); break;
+        case SOURCE_ENTITY: object = sources.get(handle); break;
+        case SINK_ENTITY: object = sinks.get(handle); break;
+        case BOX_ENTITY: object = boxes.get(handle); break;
+        case LINE_ENTITY: object = lines.get(handle); break;
+        default: break;
+    }
+    return object ? object->body : NULL;
+}
+
 ofxBox2dEdge* Level::edgeFromPolyline(const ofPolyline* line) {
-    ofxBox2dEdge* edge = new ofxBox2dEdge();
+    ofxBox2dEdge* edge = arena.create<ofxBox2dEdge>();
     for (int i = 0; i < line->size(); i++) {
         edge->addVertex((*line)[i]);
     }
@@ -314,16 +692,38 @@ ofxBox2dEdge* Level::edgeFromPolyline(const ofPolyline* line) {
 }
 
 void Level::onContactStart(ofxBox2dContactArgs &e) {
-    if (e.a != NULL) {
-        int* soundSourceIDPtrA = (int *)(e.a->GetBody()->GetUserData());
-        if (soundSourceIDPtrA) {
-            sm->Play(*soundSourceIDPtrA, 1.0);
-        }
+    if (e.a == NULL || e.b == NULL) {
+        return;
+    }
+    
+    // Strike harder the faster the bodies meet.
+    b2Vec2 velocity = e.a->GetBody()->GetLinearVelocity() - e.b->GetBody()->GetLinearVelocity();
+    float strength = ofClamp(velocity.Length() / FULL_STRIKE_SPEED, 0, 1);
+    if (strength < MIN_STRIKE_STRENGTH) {
+        return;
     }
-    if (e.b != NULL) {
-        int* soundSourceIDPtrB = (int *)(e.b->GetBody()->GetUserData());
-        if (soundSourceIDPtrB) {
-            sm->Play(*soundSourceIDPtrB, 1.0);
+    
+    // Bodies carry their handles. Stale handles and bodies from
+    // outside the level resolve to |NO_ENTITY| and ring like boxes.
+    EntityHandle handleA = EntityRegistry::fromUserData(e.a->GetBody()->GetUserData());
+    EntityHandle handleB = EntityRegistry::fromUserData(e.b->GetBody()->GetUserData());
+    SoundParticle* particleA = particles.get(handleA);
+    SoundParticle* particleB = particles.get(handleB);
+    
+    // Particles ring at their own pitch. Lines, boxes and sound
+    // circles ring at the pitch of the particle that hit them.
+    int sourceA = particleA ? particleA->getSoundSourceID() : -1;
+    int sourceB = particleB ? particleB->getSoundSourceID() : -1;
+    sm->Strike(sourceA != -1 ? sourceA : sourceB, contactMaterials[registry.getType(handleA)], strength);
+    sm->Strike(sourceB != -1 ? sourceB : sourceA, contactMaterials[registry.getType(handleB)], strength);
+    
+    // Particles also ripple the wave field where they are struck.
+    if (waveField) {
+        if (particleA) {
+            waveField->addImpulse(particleA->getPosition(), strength);
+        }
+        if (particleB) {
+            waveField->addImpulse(particleB->getPosition(), strength);
         }
     }
 }
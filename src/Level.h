@@ -3,6 +3,12 @@
 #include "ofxBox2d.h"
 #include "Particle.h"
 #include "ofSoundMixer.h"
+#include "LevelDescription.h"
+#include "LevelPack.h"
+#include "LevelArena.h"
+#include "EntityRegistry.h"
+#include "TrailBatch.h"
+#include "WaveField.h"
 
 class Level
 {
@@ -10,23 +16,71 @@ public:
     /* Creates a new level. If a filename is provided, the level
      * is prepopulated according to the description in the file. */
     Level(const std::string filename = "");
-    ~Level();
+    
+    /* Creates a new level populated from an already parsed or
+     * generated description. */
+    Level(const LevelDescription& description);
+    
+    /* Creates a new level from entry |index| of a level pack. */
+    Level(const LevelPack& pack, int index);
+    virtual ~Level();
     
     /* Loads level from a file. */
     void loadFromFile(const std::string filename);
     
+    /* Creates the objects listed in a level description. */
+    void loadFromDescription(const LevelDescription& description);
+    
+    /* Creates the objects of entry |index| of a level pack,
+     * reading the records in place. */
+    void loadFromPack(const LevelPack& pack, int index);
+    
+    /* Updates the live level after its file changed from |before|
+     * to |after|. Only objects that differ are touched; player
+     * lines, particles and unchanged bodies and voices are kept. */
+    void applyChanges(const LevelDescription& before, const LevelDescription& after);
+    
     /* Returns true if the level has been completed. */
     bool complete();
     
     /* Gets the line count in the current level. */
     int getLineCount();
     
+    /* Gets the number of particles in flight. */
+    int getParticleCount();
+    
     /* Updates all objects in this level. */
     virtual void update();
     
+    /* Game time of the next particle emission, or FLT_MAX if no
+     * source will emit again. */
+    float getNextEmissionTime();
+    
+    /* Adds a particle of the given frequency at (x, y). */
+    void addParticle(float x, float y, float frequency);
+    
     /* Draws all objects in this level. */
     virtual void draw(bool highlightsOnly = false);
     
+    /* Draws the parts of the level that change every frame, i.e.
+     * everything but the static layer. */
+    void drawDynamic();
+    
+    /* The two parts of the dynamic layer: the wave rings around
+     * sinks, and everything else. */
+    void drawWaves();
+    void drawObjects();
+    
+    /* Draws the parts of the level that rarely change: boxes,
+     * player lines and the title. Drawn on top of the dynamic
+     * layer, so it can be cached offscreen. */
+    void drawStatic();
+    
+    /* Changes whenever the static layer looks different, and is
+     * unique across levels. Callers caching the static layer
+     * redraw it when this changes. */
+    unsigned int getStaticRevision();
+    
     /* Handle key and mouse events. */
     void keyPressed(int key);
     void mouseMoved(int x, int y );
@@ -36,6 +90,19 @@ public:
     
     static void Initialize(ofxBox2d* box2d, ofSoundMixer* mixer);
     
+    /* Shows the paths particles take, in every level. */
+    static void setTrailsEnabled(bool enabled);
+    static bool getTrailsEnabled();
+    
+    /* Drives |field| with the level's sounds, in every level, or
+     * stops if it is NULL. */
+    static void setWaveField(WaveField* field);
+    
+    /* Size of the window levels are played in. Particles that leave
+     * it are removed, so replays set the recorded size rather than
+     * the actual one. Until set, the actual window size is used. */
+    static void setWindowSize(int width, int height);
+    
 private:
     /* Shared physics engine. */
     static ofxBox2d* box2d;
@@ -43,32 +110,116 @@ private:
     /* Shared audio engine. */
     static ofSoundMixer* sm;
     
+    /* Phases of |update|. */
+    void updatePreviews();
+    void emitParticles();
+    void updateParticles();
+    
+    /* Destroys particle |index| and ends its trail. */
+    void removeParticle(int index);
+    
+    /* Parts of |drawObjects|, one per object type. */
+    void drawEmitters();
+    void drawSounds();
+    void drawParticles();
+    
     /* Shared font for rendering level name. */
-    static ofTrueTypeFont font;
+    std::shared_ptr<ofTrueTypeFont> font;
+    CachedText titleText;
     
     /* Drag and drop variables. */
     int mouseX, mouseY;
     ofMutex selectionMutex;
     std::shared_ptr<ofPolyline> currentLine;
-    b2Body* selectedBody = NULL;
+    EntityHandle selected = NULL_ENTITY;
     
     /* Level play start time. */
     float startTime = -1.f;
     
+    /* Mixer sequence playing the sinks' pitches, and the game time
+     * it started at. */
+    int previewSequence = -1;
+    float previewStartTime = 0.f;
+    void startPreview();
+    
     /* Level title. */
     std::string title;
     
-    /* Level source(s) and sink(s). */
-    std::shared_ptr<ParticleSource> source;
-    std::shared_ptr<ParticleSink> sink;
-    
-    /* Level objects. */
-    std::vector<std::shared_ptr<ParticleSource> > sources;
-    std::vector<std::shared_ptr<ParticleSink> > sinks;
-    std::vector<std::shared_ptr<SoundSource> > circles;
-    std::vector<std::shared_ptr<SoundParticle> > particles;
-    std::vector<std::shared_ptr<ofxBox2dRect> > boxes;
-    std::vector<std::shared_ptr<ofxBox2dEdge> > lines;
+    /* See |getStaticRevision|. */
+    static unsigned int revisionCounter;
+    unsigned int staticRevision;
+    void invalidateStatic();
+    
+    /* Owns all level objects below. Released in one go when the
+     * level is destroyed. */
+    LevelArena arena;
+    
+    /* Level objects, allocated from |arena|, by type. Each object's
+     * body carries its handle as user data. */
+    EntityRegistry registry;
+    EntityArray<ParticleSource> sources{registry, SOURCE_ENTITY};
+    EntityArray<ParticleSink> sinks{registry, SINK_ENTITY};
+    EntityArray<SoundSource> circles{registry, SOUND_ENTITY};
+    EntityArray<SoundParticle> particles{registry, PARTICLE_ENTITY};
+    EntityArray<ofxBox2dRect> boxes{registry, BOX_ENTITY};
+    EntityArray<ofxBox2dEdge> lines{registry, LINE_ENTITY};
+    
+    /* Adds |object| to |objects| and tags its body with its handle. */
+    template <class T>
+    void addEntity(EntityArray<T>& objects, T* object) {
+        object->setData(EntityRegistry::toUserData(objects.add(object)));
+    }
+    
+    /* Replaces the object at |index| of |objects| with |object|.
+     * The old handle goes stale, which also ends a drag of it. */
+    template <class T>
+    void replaceEntity(EntityArray<T>& objects, int index, T* object) {
+        arena.destroy(objects[index]);
+        object->setData(EntityRegistry::toUserData(objects.replace(index, object)));
+    }
+    
+    /* Body of the object of |handle|, or NULL if the handle is stale. */
+    b2Body* getBody(EntityHandle handle);
+    
+    /* Positions and pitches of the sound circles, gathered once per
+     * update so the tests against every particle run over packed
+     * data instead of chasing each circle's body. */
+    std::vector<ofVec2f> circlePositions;
+    std::vector<float> circleFrequencies;
+    
+    /* Reused every frame to draw circles in bulk. */
+    CircleBatch emitterBatch;
+    CircleBatch particleBatch;
+    
+    /* Particle trails. Each particle holds the ID of its trail. */
+    static bool trailsEnabled;
+    TrailBatch trails;
+    
+    /* Wave simulation driven by sounding objects, if any. */
+    static WaveField* waveField;
+    
+    /* See |setWindowSize|; 0 until set. */
+    static int windowWidth, windowHeight;
+    static int getWindowWidth();
+    static int getWindowHeight();
+    
+    /* Color for objects of the given frequency, from red for low
+     * pitches to blue for high ones. */
+    static ofColor getFrequencyColor(float frequency);
+    
+    /* Helper methods for creating level objects. */
+    ofxBox2dRect* createBox(float x, float y, float width, float height);
+    SoundSource* createSound(float x, float y, float freq);
+    ParticleSource* createSource(float x, float y, const std::vector<int>& pattern);
+    ParticleSink* createSink(float x, float y, float freq, int limit);
+    
+    /* Destroys the objects past the first |count| in |objects|. */
+    template <class T>
+    void truncate(EntityArray<T>& objects, int count) {
+        while (objects.size() > count) {
+            arena.destroy(objects.remove(objects.size() - 1));
+        }
+    }
     
     /* Helper method for converting polyline to box2d edge. */
     ofxBox2dEdge* edgeFromPolyline(const ofPolyline* line);
@@ -76,4 +227,8 @@ private:
     /* Contact callbacks */
     void onContactStart(ofxBox2dContactArgs &e);
     void onContactEnd(ofxBox2dContactArgs &e);
+    
+    /* Material a contact sound rings with, by the type of the object
+     * struck. */
+    static const ResonatorMaterial contactMaterials[ENTITY_TYPE_COUNT];
 };
@@ -0,0 +1,108 @@
+#include "LevelArena.h"
+
+#include <stdlib.h>
+
+/* Header size rounded up so objects stay aligned. */
+#define HEADER_SIZE ((sizeof(Header) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT)
+
+LevelArena::LevelArena(size_t blockSize)
+: blockSize(blockSize) {
+    for (int i = 0; i < SIZE_CLASSES; i++) {
+        freeLists[i] = NULL;
+    }
+}
+
+LevelArena::~LevelArena() {
+    release();
+}
+
+void* LevelArena::allocate(size_t size, void (*destructor)(void*)) {
+    size_t sizeClass = (size + ALIGNMENT - 1) / ALIGNMENT;
+    size_t slotSize = HEADER_SIZE + sizeClass * ALIGNMENT;
+    
+    // Reuse the slot of a destroyed object of the same size...
+    Header* header = NULL;
+    if (sizeClass < SIZE_CLASSES && freeLists[sizeClass]) {
+        header = freeLists[sizeClass];
+        freeLists[sizeClass] = header->next;
+    }
+    // ...or bump-allocate, starting a new block if needed.
+    else {
+        if (cursor == NULL || cursor + slotSize > end) {
+            size_t reserve = slotSize > blockSize ? slotSize : blockSize;
+            char* block = (char *)malloc(reserve);
+            if (!block) {
+                throw std::bad_alloc();
+            }
+            blocks.push_back(block);
+            reservedBytes += reserve;
+            cursor = block;
+            end = block + reserve;
+        }
+        header = (Header *)cursor;
+        cursor += slotSize;
+    }
+    
+    header->destructor = destructor;
+    header->sizeClass = sizeClass;
+    header->prev = NULL;
+    header->next = live;
+    if (live) {
+        live->prev = header;
+    }
+    live = header;
+    objectCount++;
+    return (char *)header + HEADER_SIZE;
+}
+
+void LevelArena::free(void* object) {
+    Header* header = (Header *)((char *)object - HEADER_SIZE);
+    header->destructor(object);
+    
+    // Unlink from the live list.
+    if (header->prev) {
+        header->prev->next = header->next;
+    }
+    else {
+        live = header->next;
+    }
+    if (header->next) {
+        header->next->prev = header->prev;
+    }
+    objectCount--;
+    
+    if (header->sizeClass < SIZE_CLASSES) {
+        header->next = freeLists[header->sizeClass];
+        freeLists[header->sizeClass] = header;
+    }
+}
+
+void LevelArena::release() {
+    // Destroy newest first, i.e. in reverse order of creation.
+    for (Header* header = live; header; ) {
+        Header* next = header->next;
+        header->destructor((char *)header + HEADER_SIZE);
+        header = next;
+    }
+    live = NULL;
+    objectCount = 0;
+    
+    for (int i = 0; i < blocks.size(); i++) {
+        ::free(blocks[i]);
+    }
+    blocks.clear();
+    cursor = NULL;
+    end = NULL;
+    reservedBytes = 0;
+    for (int i = 0; i < SIZE_CLASSES; i++) {
+        freeLists[i] = NULL;
+    }
+}
+
+size_t LevelArena::getObjectCount() const {
+    return objectCount;
+}
+
+size_t LevelArena::getReservedBytes() const {
+    return reservedBytes;
+}
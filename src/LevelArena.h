@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+#include <utility>
+#include <vector>
+
+/* Monotonic arena for objects owned by a |Level|. Objects are
+ * carved out of large blocks and all of them are destroyed and
+ * released in one go when the level goes away. Objects that die
+ * early, like particles, can be destroyed individually; their
+ * memory is recycled for later objects of a similar size rather
+ * than returned to the system. Not thread safe. */
+class LevelArena
+{
+public:
+    LevelArena(size_t blockSize = 64 * 1024);
+    ~LevelArena();
+    
+    /* Constructs a T in the arena. The arena owns the object. */
+    template <class T, class... Args>
+    T* create(Args&&... args) {
+        void* memory = allocate(sizeof(T), &destroyObject<T>);
+        return new (memory) T(std::forward<Args>(args)...);
+    }
+    
+    /* Destroys an object before the arena is released. Must be
+     * given the pointer returned by |create|. */
+    template <class T>
+    void destroy(T* object) {
+        if (object) {
+            free((void *)object);
+        }
+    }
+    
+    /* Destroys all live objects, newest first, and releases all
+     * memory. The arena can be reused afterwards. */
+    void release();
+    
+    /* Number of live objects and bytes reserved from the system. */
+    size_t getObjectCount() const;
+    size_t getReservedBytes() const;
+    
+private:
+    /* Bookkeeping stored in front of every object. Live objects
+     * are linked together so |release| can destroy them; dead
+     * ones are linked into the free list for their size. */
+    struct Header {
+        void (*destructor)(void*);
+        Header* prev;
+        Header* next;
+        size_t sizeClass;
+    };
+    
+    template <class T>
+    static void destroyObject(void* object) {
+        ((T *)object)->~T();
+    }
+    
+    void* allocate(size_t size, void (*destructor)(void*));
+    void free(void* object);
+    
+    size_t blockSize;
+    std::vector<char*> blocks;
+    char* cursor = NULL;
+    char* end = NULL;
+    size_t reservedBytes = 0;
+    
+    Header* live = NULL;
+    size_t objectCount = 0;
+    
+    /* Free lists by size in |ALIGNMENT| steps. Larger objects
+     * are not recycled. */
+    static const size_t ALIGNMENT = 16;
+    static const size_t SIZE_CLASSES = 64;
+    Header* freeLists[SIZE_CLASSES];
+};
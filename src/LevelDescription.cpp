@@ -0,0 +1,98 @@
+#include "LevelDescription.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+const static std::string BOX("box");
+const static std::string SOUND("sound");
+const static std::string SOURCE("source");
+const static std::string SINK("sink");
+
+void LevelDescription::parse(std::istream& in) {
+    std::string line;
+
+    // Get title
+    std::getline(in, line);
+    title = line;
+
+    while (std::getline(in, line)) {
+        // Skip empty lines and comment lines.
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        // Fetch line prefix.
+        std::istringstream ss(line);
+        std::string prefix;
+        ss >> prefix;
+
+        // Add objects according to instruction from prefix.
+        if (prefix == BOX) {
+            BoxDescription box;
+            ss >> box.x >> box.y >> box.width >> box.height;
+            boxes.push_back(box);
+        }
+        else if (prefix == SOUND) {
+            SoundDescription sound;
+            ss >> sound.x >> sound.y >> sound.freq;
+            sounds.push_back(sound);
+        }
+        else if (prefix == SOURCE) {
+            SourceDescription source;
+            float freq;
+            ss >> source.x >> source.y;
+            while (ss >> freq) {
+                source.pattern.push_back(freq);
+            }
+            sources.push_back(source);
+        }
+        else if (prefix == SINK) {
+            SinkDescription sink;
+            ss >> sink.x >> sink.y >> sink.freq >> sink.limit;
+            sinks.push_back(sink);
+        }
+    }
+}
+
+bool LevelDescription::loadFromFile(const std::string path) {
+    std::ifstream infile(path.c_str());
+    if (!infile) {
+        std::cerr << "Could not open level file " << path << std::endl;
+        return false;
+    }
+    parse(infile);
+    return true;
+}
+
+void LevelDescription::write(std::ostream& out) const {
+    out << title << std::endl;
+    for (int i = 0; i < boxes.size(); i++) {
+        const BoxDescription& box = boxes[i];
+        out << BOX << " " << box.x << " " << box.y << " " << box.width << " " << box.height << std::endl;
+    }
+    for (int i = 0; i < sources.size(); i++) {
+        const SourceDescription& source = sources[i];
+        out << SOURCE << " " << source.x << " " << source.y;
+        for (int j = 0; j < source.pattern.size(); j++) {
+            out << " " << source.pattern[j];
+        }
+        out << std::endl;
+    }
+    for (int i = 0; i < sinks.size(); i++) {
+        const SinkDescription& sink = sinks[i];
+        out << SINK << " " << sink.x << " " << sink.y << " " << sink.freq << " " << sink.limit << std::endl;
+    }
+    for (int i = 0; i < sounds.size(); i++) {
+        const SoundDescription& sound = sounds[i];
+        out << SOUND << " " << sound.x << " " << sound.y << " " << sound.freq << std::endl;
+    }
+}
+
+void LevelDescription::clear() {
+    title.clear();
+    boxes.clear();
+    sounds.clear();
+    sources.clear();
+    sinks.clear();
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
+
+/* Plain-data description of a level, i.e. everything that
+ * is in a level file. Holds no physics bodies or voices, so
+ * it can be parsed or generated away from the main thread
+ * and turned into a |Level| later. Doesn't depend on
+ * openFrameworks, so tools can share the parser. */
+struct BoxDescription {
+    float x, y, width, height;
+};
+
+struct SoundDescription {
+    float x, y, freq;
+};
+
+struct SourceDescription {
+    float x, y;
+    std::vector<int> pattern;
+};
+
+struct SinkDescription {
+    float x, y, freq;
+    int limit;
+};
+
+class LevelDescription
+{
+public:
+    std::string title;
+    std::vector<BoxDescription> boxes;
+    std::vector<SoundDescription> sounds;
+    std::vector<SourceDescription> sources;
+    std::vector<SinkDescription> sinks;
+
+    /* Parses a level in the text level format. The first line
+     * is the title, followed by one object per line. */
+    void parse(std::istream& in);
+
+    /* Loads a level file from an absolute path. Returns false if
+     * the file could not be opened. */
+    bool loadFromFile(const std::string path);
+
+    /* Writes this level in the text level format. */
+    void write(std::ostream& out) const;
+
+    /* Removes all objects and the title. */
+    void clear();
+};
@@ -0,0 +1,251 @@
+#include "LevelGenerator.h"
+
+#include "ofxBox2d.h"
+
+/* Levels are laid out for the default window size. */
+#define LEVEL_WIDTH 1024.f
+#define LEVEL_HEIGHT 768.f
+
+/* Physics constants, mirroring the values used by |Level|. */
+#define GRAVITY (10.f * OFX_BOX2D_SCALE)
+#define FRICTION 0.1f
+#define PARTICLE_RADIUS 10.f
+#define OBJECT_RADIUS 50.f
+#define CAPTURE_RADIUS 25.f
+#define FREQUENCY_TOLERANCE 20.f
+
+/* Headless simulation settings. */
+#define SIMULATION_STEP (1.f / 90.f)
+#define SIMULATION_TIME 10.f
+#define REPEL_CLEARANCE 100.f
+#define WAYPOINT_COLUMNS 8
+#define WAYPOINT_ROWS 6
+
+/* Give up on a level after this many attempts and use the
+ * most recent one regardless. */
+#define MAX_ATTEMPTS 200
+
+static const int FREQUENCIES[] = { 440, 660, 880 };
+static const int FREQUENCY_COUNT = sizeof(FREQUENCIES) / sizeof(FREQUENCIES[0]);
+
+LevelGenerator::LevelGenerator(unsigned int seed)
+: seed(seed) {
+}
+
+/* Returns true if |point| lies within |margin| of |box|. */
+static bool boxContains(const BoxDescription& box, const ofVec2f& point, float margin) {
+    return point.x > box.x - box.width / 2.f - margin &&
+           point.x < box.x + box.width / 2.f + margin &&
+           point.y > box.y - box.height / 2.f - margin &&
+           point.y < box.y + box.height / 2.f + margin;
+}
+
+/* Simulates a particle sliding down a straight ramp from |start|
+ * to |end|, entering with speed |speed|. Returns false if the
+ * ramp isn't steep enough, hits a box, or passes too close to a
+ * sound circle that would repel the particle. On success |speed|
+ * holds the exit speed. */
+static bool simulateRamp(const LevelDescription& description, const ofVec2f& start,
+                         const ofVec2f& end, float freq, float& speed) {
+    ofVec2f delta = end - start;
+    float length = delta.length();
+    if (length <= 0.f) {
+        return true;
+    }
+    ofVec2f direction = delta / length;
+    float acceleration = GRAVITY * (direction.y - FRICTION * fabs(direction.x));
+    if (acceleration <= 0.f) {
+        return false;
+    }
+
+    float travelled = 0.f;
+    for (float t = 0.f; t < SIMULATION_TIME; t += SIMULATION_STEP) {
+        speed += acceleration * SIMULATION_STEP;
+        travelled += speed * SIMULATION_STEP;
+        if (travelled >= length) {
+            return true;
+        }
+
+        ofVec2f position = start + direction * travelled;
+        for (int i = 0; i < description.boxes.size(); i++) {
+            if (boxContains(description.boxes[i], position, PARTICLE_RADIUS)) {
+                return false;
+            }
+        }
+        for (int i = 0; i < description.sounds.size(); i++) {
+            const SoundDescription& sound = description.sounds[i];
+            if (fabs(sound.freq - freq) <= FREQUENCY_TOLERANCE &&
+                position.distance(ofVec2f(sound.x, sound.y)) < REPEL_CLEARANCE) {
+                return false;
+            }
+        }
+    }
+    return false;
+}
+
+/* Returns true if a particle of frequency |freq| released at
+ * |source| can reach |sink| along a one or two segment ramp. */
+static bool canReach(const LevelDescription& description, const ofVec2f& source,
+                     const ofVec2f& sink, float freq) {
+    // Particles within the capture radius are collected, so aim
+    // the ramp just above the sink.
+    ofVec2f target(sink.x, sink.y - CAPTURE_RADIUS);
+
+    float speed = 0.f;
+    if (simulateRamp(description, source, target, freq, speed)) {
+        return true;
+    }
+
+    for (int i = 0; i < WAYPOINT_COLUMNS; i++) {
+        for (int j = 0; j < WAYPOINT_ROWS; j++) {
+            ofVec2f waypoint(LEVEL_WIDTH * (i + 0.5f) / WAYPOINT_COLUMNS,
+                             LEVEL_HEIGHT * (j + 0.5f) / WAYPOINT_ROWS);
+            if (waypoint.y <= source.y || waypoint.y >= target.y) {
+                continue;
+            }
+            speed = 0.f;
+            if (!simulateRamp(description, source, waypoint, freq, speed)) {
+                continue;
+            }
+
+            // Keep only the part of the velocity along the new ramp.
+            ofVec2f first = (waypoint - source).getNormalized();
+            ofVec2f second = (target - waypoint).getNormalized();
+            speed *= max(0.f, first.dot(second));
+            if (simulateRamp(description, waypoint, target, freq, speed)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool LevelGenerator::isSolvable(const LevelDescription& description) {
+    if (description.sources.empty() || description.sinks.empty()) {
+        return false;
+    }
+
+    for (int i = 0; i < description.sinks.size(); i++) {
+        const SinkDescription& sink = description.sinks[i];
+        ofVec2f sinkPosition(sink.x, sink.y);
+
+        bool reachable = false;
+        for (int j = 0; j < description.sources.size() && !reachable; j++) {
+            const SourceDescription& source = description.sources[j];
+            for (int k = 0; k < source.pattern.size() && !reachable; k++) {
+                if (fabs(source.pattern[k] - sink.freq) > FREQUENCY_TOLERANCE) {
+                    continue;
+                }
+                reachable = canReach(description, ofVec2f(source.x, source.y),
+                                     sinkPosition, source.pattern[k]);
+            }
+        }
+        if (!reachable) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Returns true if |point| is at least |distance| away from all
+ * of the given positions. */
+static bool isClear(const std::vector<ofVec2f>& taken, const ofVec2f& point, float distance) {
+    for (int i = 0; i < taken.size(); i++) {
+        if (taken[i].distance(point) < distance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+unsigned int LevelGenerator::getSeed() const {
+    return seed;
+}
+
+void LevelGenerator::setSeed(unsigned int seed) {
+    this->seed = seed;
+}
+
+void LevelGenerator::generate(int number, LevelDescription& description) const {
+    std::mt19937 random(seed + number);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+    int sinkCount = 1 + min(2, number / 4);
+    int soundCount = min(5, number / 2);
+    int boxCount = min(3, number / 5);
+
+    for (int attempt = 0; attempt < MAX_ATTEMPTS; attempt++) {
+        description.clear();
+        std::ostringstream title;
+        title << number << ". Endless";
+        description.title = title.str();
+
+        std::vector<ofVec2f> taken;
+
+        // Pick the sink frequencies first, then make sure the
+        // source emits all of them.
+        std::vector<int> frequencies;
+        for (int i = 0; i < sinkCount; i++) {
+            frequencies.push_back(FREQUENCIES[random() % FREQUENCY_COUNT]);
+        }
+
+        // Source near the top of the screen.
+        SourceDescription source;
+        source.x = 75.f + unit(random) * (LEVEL_WIDTH - 150.f);
+        source.y = 100.f + unit(random) * 150.f;
+        source.pattern = frequencies;
+        std::shuffle(source.pattern.begin(), source.pattern.end(), random);
+        description.sources.push_back(source);
+        taken.push_back(ofVec2f(source.x, source.y));
+
+        // Sinks near the bottom, spread apart.
+        for (int i = 0; i < sinkCount; i++) {
+            SinkDescription sink;
+            for (int tries = 0; tries < 20; tries++) {
+                sink.x = 75.f + unit(random) * (LEVEL_WIDTH - 150.f);
+                sink.y = 450.f + unit(random) * 250.f;
+                if (isClear(taken, ofVec2f(sink.x, sink.y), 4.f * OBJECT_RADIUS)) {
+                    break;
+                }
+            }
+            sink.freq = frequencies[i];
+            sink.limit = 3 + random() % 3;
+            description.sinks.push_back(sink);
+            taken.push_back(ofVec2f(sink.x, sink.y));
+        }
+
+        // Sound circles anywhere in between.
+        for (int i = 0; i < soundCount; i++) {
+            SoundDescription sound;
+            sound.x = 50.f + unit(random) * (LEVEL_WIDTH - 100.f);
+            sound.y = 250.f + unit(random) * 400.f;
+            sound.freq = FREQUENCIES[random() % FREQUENCY_COUNT];
+            if (isClear(taken, ofVec2f(sound.x, sound.y), 2.f * OBJECT_RADIUS)) {
+                description.sounds.push_back(sound);
+            }
+        }
+
+        // Walls and blocks, kept off the source and sinks.
+        for (int i = 0; i < boxCount; i++) {
+            BoxDescription box;
+            bool vertical = unit(random) < 0.5f;
+            box.width = vertical ? 10.f + unit(random) * 40.f : 100.f + unit(random) * 200.f;
+            box.height = vertical ? 100.f + unit(random) * 300.f : 10.f + unit(random) * 40.f;
+            box.x = unit(random) * LEVEL_WIDTH;
+            box.y = 150.f + unit(random) * 500.f;
+
+            bool clear = true;
+            for (int j = 0; j < taken.size() && clear; j++) {
+                clear = !boxContains(box, taken[j], OBJECT_RADIUS + PARTICLE_RADIUS);
+            }
+            if (clear) {
+                description.boxes.push_back(box);
+            }
+        }
+
+        if (isSolvable(description)) {
+            return;
+        }
+    }
+    std::cerr << "Could not generate a solvable level " << number << std::endl;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "ofMain.h"
+#include "LevelDescription.h"
+
+#include <random>
+
+/* Generates random levels for endless mode. Generation only
+ * touches plain level descriptions, so it is safe to run on a
+ * background thread; see |LevelPrefetcher|. */
+class LevelGenerator
+{
+public:
+    /* Levels are seeded with |seed| plus the level number, so a
+     * given seed always produces the same sequence of levels. */
+    LevelGenerator(unsigned int seed);
+    
+    /* Changing the seed is not thread-safe; only do it before
+     * anything is generated in the background. */
+    unsigned int getSeed() const;
+    void setSeed(unsigned int seed);
+
+    /* Fills |description| with a solvable random level. Difficulty,
+     * i.e. the number of sinks, sound circles and boxes, grows with
+     * the level number. */
+    void generate(int number, LevelDescription& description) const;
+
+    /* Returns true if every sink can be reached by a particle of
+     * its frequency. Runs a quick headless simulation of a particle
+     * sliding down a player-drawn ramp, so it is a heuristic: a
+     * level that fails may still be solvable by a clever player. */
+    static bool isSolvable(const LevelDescription& description);
+
+private:
+    unsigned int seed;
+};
@@ -0,0 +1,108 @@
+#include "LevelPack.h"
+
+#include <iostream>
+#include <string.h>
+
+bool LevelPack::open(const std::string path) {
+    close();
+    if (!file.open(path)) {
+        return false;
+    }
+
+    // Check the header before trusting any offsets in it.
+    if (file.getSize() < sizeof(LevelPackHeader)) {
+        std::cerr << "Level pack is truncated: " << path << std::endl;
+        close();
+        return false;
+    }
+    const LevelPackHeader* candidate = (const LevelPackHeader *)file.getData();
+    if (candidate->magic != LEVEL_PACK_MAGIC || candidate->version != LEVEL_PACK_VERSION) {
+        std::cerr << "Not a version " << LEVEL_PACK_VERSION << " level pack: " << path << std::endl;
+        close();
+        return false;
+    }
+    header = candidate;
+    if (!validSection(header->levels, sizeof(LevelPackLevel)) ||
+        !validSection(header->boxes, sizeof(LevelPackBox)) ||
+        !validSection(header->sounds, sizeof(LevelPackSound)) ||
+        !validSection(header->sources, sizeof(LevelPackSource)) ||
+        !validSection(header->sinks, sizeof(LevelPackSink)) ||
+        !validSection(header->notes, sizeof(int32_t)) ||
+        !validSection(header->strings, 1)) {
+        std::cerr << "Level pack is corrupt: " << path << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void LevelPack::close() {
+    header = NULL;
+    file.close();
+}
+
+bool LevelPack::isOpen() const {
+    return header != NULL;
+}
+
+int LevelPack::getLevelCount() const {
+    return header ? header->levels.count : 0;
+}
+
+const LevelPackLevel* LevelPack::getLevel(int index) const {
+    if (!header || index < 0 || index >= header->levels.count) {
+        return NULL;
+    }
+    const LevelPackLevel* level = record<LevelPackLevel>(header->levels, index);
+    if (!validRange(level->firstBox, level->boxCount, header->boxes) ||
+        !validRange(level->firstSound, level->soundCount, header->sounds) ||
+        !validRange(level->firstSource, level->sourceCount, header->sources) ||
+        !validRange(level->firstSink, level->sinkCount, header->sinks) ||
+        level->title >= header->strings.count) {
+        return NULL;
+    }
+
+    // The title must be terminated within the string table.
+    const char* title = record<char>(header->strings, level->title);
+    if (!memchr(title, '\0', header->strings.count - level->title)) {
+        return NULL;
+    }
+    return level;
+}
+
+const char* LevelPack::getTitle(const LevelPackLevel& level) const {
+    return record<char>(header->strings, level.title);
+}
+
+const LevelPackBox* LevelPack::getBoxes(const LevelPackLevel& level) const {
+    return record<LevelPackBox>(header->boxes, level.firstBox);
+}
+
+const LevelPackSound* LevelPack::getSounds(const LevelPackLevel& level) const {
+    return record<LevelPackSound>(header->sounds, level.firstSound);
+}
+
+const LevelPackSource* LevelPack::getSources(const LevelPackLevel& level) const {
+    return record<LevelPackSource>(header->sources, level.firstSource);
+}
+
+const LevelPackSink* LevelPack::getSinks(const LevelPackLevel& level) const {
+    return record<LevelPackSink>(header->sinks, level.firstSink);
+}
+
+const int32_t* LevelPack::getNotes(const LevelPackSource& source) const {
+    if (!validRange(source.firstNote, source.noteCount, header->notes)) {
+        return NULL;
+    }
+    return record<int32_t>(header->notes, source.firstNote);
+}
+
+bool LevelPack::validSection(const LevelPackSection& section, size_t recordSize) const {
+    // Widen before multiplying so huge counts can't wrap around.
+    uint64_t end = (uint64_t)section.offset + (uint64_t)section.count * recordSize;
+    return section.offset % 4 == 0 && end <= file.getSize();
+}
+
+bool LevelPack::validRange(uint32_t first, uint32_t count, const LevelPackSection& section) {
+    return (uint64_t)first + count <= section.count;
+}
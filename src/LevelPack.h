@@ -0,0 +1,55 @@
+#pragma once
+
+#include "LevelPackFormat.h"
+#include "MappedFile.h"
+
+/* A compiled level pack, memory-mapped and read in place. See
+ * LevelPackFormat.h for the layout. Looking up a level is
+ * constant time regardless of how many levels the pack holds. */
+class LevelPack
+{
+public:
+    /* Maps and validates the pack at the given absolute path.
+     * Returns false if the file is missing or malformed. */
+    bool open(const std::string path);
+    void close();
+    bool isOpen() const;
+
+    /* Number of levels in the pack. */
+    int getLevelCount() const;
+
+    /* Index entry for the level at |index|. Returns NULL if the
+     * index is out of range or the entry points outside the pack. */
+    const LevelPackLevel* getLevel(int index) const;
+
+    /* Title of a level returned by |getLevel|. */
+    const char* getTitle(const LevelPackLevel& level) const;
+
+    /* Object records for a level returned by |getLevel|. Each points at
+     * |level.<type>Count| records. */
+    const LevelPackBox* getBoxes(const LevelPackLevel& level) const;
+    const LevelPackSound* getSounds(const LevelPackLevel& level) const;
+    const LevelPackSource* getSources(const LevelPackLevel& level) const;
+    const LevelPackSink* getSinks(const LevelPackLevel& level) const;
+
+    /* Emission pattern notes for a source. Points at
+     * |source.noteCount| notes, or NULL if the range is invalid. */
+    const int32_t* getNotes(const LevelPackSource& source) const;
+
+private:
+    /* Returns true if |section| of |recordSize| byte records
+     * lies within the mapping. */
+    bool validSection(const LevelPackSection& section, size_t recordSize) const;
+
+    /* Returns true if |first| and |count| index into |section|. */
+    static bool validRange(uint32_t first, uint32_t count, const LevelPackSection& section);
+
+    /* Returns a pointer to the record at |index| within |section|. */
+    template <class T>
+    const T* record(const LevelPackSection& section, uint32_t index) const {
+        return (const T *)(file.getData() + section.offset) + index;
+    }
+
+    MappedFile file;
+    const LevelPackHeader* header = NULL;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdint.h>
+
+/* On-disk layout of a compiled level pack. A pack is a header
+ * followed by flat arrays of fixed-size records, so it can be
+ * memory-mapped and read in place. All offsets are in bytes
+ * from the start of the file, all records are 4-byte aligned,
+ * and values are stored in host byte order. Build packs with
+ * tools/levelpack. */
+
+#define LEVEL_PACK_MAGIC 0x4b505353 /* "SSPK" */
+#define LEVEL_PACK_VERSION 1
+
+/* Location of one array of records within the pack. */
+struct LevelPackSection {
+    uint32_t offset;
+    uint32_t count;
+};
+
+struct LevelPackHeader {
+    uint32_t magic;
+    uint32_t version;
+    LevelPackSection levels;
+    LevelPackSection boxes;
+    LevelPackSection sounds;
+    LevelPackSection sources;
+    LevelPackSection sinks;
+    LevelPackSection notes;
+    LevelPackSection strings;
+};
+
+/* Index entry for one level. The object ranges index into the
+ * pack-wide arrays of the corresponding record type. */
+struct LevelPackLevel {
+    uint32_t title; /* Offset into the string table. */
+    uint32_t firstBox, boxCount;
+    uint32_t firstSound, soundCount;
+    uint32_t firstSource, sourceCount;
+    uint32_t firstSink, sinkCount;
+};
+
+struct LevelPackBox {
+    float x, y, width, height;
+};
+
+struct LevelPackSound {
+    float x, y, freq;
+};
+
+/* Emission pattern notes live in the pack-wide note array. */
+struct LevelPackSource {
+    float x, y;
+    uint32_t firstNote, noteCount;
+};
+
+struct LevelPackSink {
+    float x, y, freq;
+    int32_t limit;
+};
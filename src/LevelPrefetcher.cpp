@@ -0,0 +1,77 @@
+#include "LevelPrefetcher.h"
+#include "Allocations.h"
+
+LevelPrefetcher::LevelPrefetcher(const LevelGenerator& generator)
+: generator(generator) {
+}
+
+LevelPrefetcher::~LevelPrefetcher() {
+    waitForThread(true);
+}
+
+void LevelPrefetcher::requestFile(int index, const std::string path) {
+    lock();
+    if (requestedIndex != index || requestedPath != path) {
+        requestedIndex = index;
+        requestedPath = path;
+        readyIndex = -1;
+        ready.clear();
+    }
+    unlock();
+}
+
+void LevelPrefetcher::requestGenerated(int index) {
+    requestFile(index, "");
+}
+
+bool LevelPrefetcher::take(int index, LevelDescription& description) {
+    bool taken = false;
+    lock();
+    if (readyIndex == index) {
+        std::swap(description, ready);
+        ready.clear();
+        readyIndex = -1;
+        requestedIndex = -1;
+        taken = true;
+    }
+    unlock();
+    return taken;
+}
+
+void LevelPrefetcher::threadedFunction() {
+    while (isThreadRunning()) {
+        lock();
+        int index = requestedIndex;
+        std::string path = requestedPath;
+        bool pending = index != -1 && readyIndex != index;
+        unlock();
+        
+        if (!pending) {
+            sleep(5);
+            continue;
+        }
+        
+        AllocationScope allocationScope(Allocations::LEVEL_LOAD);
+        LevelDescription description;
+        if (path.empty()) {
+            generator.generate(index + 1, description);
+        }
+        else if (!description.loadFromFile(path)) {
+            // Leave it to the main thread to report and recover.
+            lock();
+            if (requestedIndex == index && requestedPath == path) {
+                requestedIndex = -1;
+            }
+            unlock();
+            continue;
+        }
+        
+        // Only publish the level if it is still the one wanted.
+        lock();
+        if (requestedIndex == index && requestedPath == path) {
+            std::swap(ready, description);
+            readyIndex = index;
+        }
+        unlock();
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "ofMain.h"
+#include "LevelDescription.h"
+#include "LevelGenerator.h"
+
+/* Prepares the next level on a background thread while the
+ * current one is being played, either by parsing its level file
+ * or by generating it. Only plain level descriptions are built
+ * here; the physics bodies and voices are still created on the
+ * main thread by |Level|. */
+class LevelPrefetcher : public ofThread
+{
+public:
+    LevelPrefetcher(const LevelGenerator& generator);
+    ~LevelPrefetcher();
+    
+    /* Asks for level |index| to be parsed from the level file at
+     * the given absolute path. Replaces any earlier request. */
+    void requestFile(int index, const std::string path);
+    
+    /* Asks for level |index| to be generated. Replaces any
+     * earlier request. */
+    void requestGenerated(int index);
+    
+    /* If level |index| is ready, moves it into |description| and
+     * returns true. Never blocks. */
+    bool take(int index, LevelDescription& description);
+    
+protected:
+    void threadedFunction();
+    
+private:
+    const LevelGenerator& generator;
+    
+    /* Shared with the background thread; guarded by |mutex|. */
+    int requestedIndex = -1;
+    std::string requestedPath;
+    int readyIndex = -1;
+    LevelDescription ready;
+};
@@ -0,0 +1,106 @@
+#include "LevelWatcher.h"
+
+#include <sys/stat.h>
+#ifdef TARGET_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+LevelWatcher::LevelWatcher() {
+#ifdef TARGET_LINUX
+    inotifyFd = inotify_init();
+    if (inotifyFd < 0) {
+        std::cerr << "Could not initialize inotify, level files won't be watched." << std::endl;
+    }
+    else {
+        fcntl(inotifyFd, F_SETFL, fcntl(inotifyFd, F_GETFL) | O_NONBLOCK);
+    }
+#endif
+}
+
+LevelWatcher::~LevelWatcher() {
+    stop();
+#ifdef TARGET_LINUX
+    if (inotifyFd >= 0) {
+        close(inotifyFd);
+    }
+#endif
+}
+
+void LevelWatcher::watch(const std::string path) {
+    stop();
+    this->path = path;
+    
+#ifdef TARGET_LINUX
+    if (inotifyFd < 0) {
+        return;
+    }
+    size_t separator = path.find_last_of('/');
+    std::string directory = separator == std::string::npos ? "." : path.substr(0, separator);
+    fileName = path.substr(separator + 1);
+    watchDescriptor = inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (watchDescriptor < 0) {
+        std::cerr << "Could not watch " << directory << std::endl;
+    }
+#else
+    struct stat info;
+    lastModified = stat(path.c_str(), &info) == 0 ? info.st_mtime : 0;
+    lastPollTime = ofGetElapsedTimef();
+#endif
+}
+
+void LevelWatcher::stop() {
+#ifdef TARGET_LINUX
+    if (watchDescriptor >= 0) {
+        inotify_rm_watch(inotifyFd, watchDescriptor);
+        watchDescriptor = -1;
+    }
+    fileName.clear();
+#endif
+    path.clear();
+}
+
+bool LevelWatcher::hasChanged() {
+    if (path.empty()) {
+        return false;
+    }
+    
+#ifdef TARGET_LINUX
+    if (watchDescriptor < 0) {
+        return false;
+    }
+    
+    // Drain all pending events and look for our file.
+    bool changed = false;
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t length;
+    while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+        for (char* ptr = buffer; ptr < buffer + length; ) {
+            const struct inotify_event* event = (const struct inotify_event *)ptr;
+            if (event->wd == watchDescriptor && event->len > 0 && fileName == event->name) {
+                changed = true;
+            }
+            ptr += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    return changed;
+#else
+    float now = ofGetElapsedTimef();
+    if (now - lastPollTime < pollInterval) {
+        return false;
+    }
+    lastPollTime = now;
+    
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0 || info.st_mtime == lastModified) {
+        return false;
+    }
+    lastModified = info.st_mtime;
+    return true;
+#endif
+}
+
+const std::string& LevelWatcher::getPath() const {
+    return path;
+}
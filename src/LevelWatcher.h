@@ -0,0 +1,43 @@
+#pragma once
+
+#include "ofMain.h"
+
+/* Watches a level file for changes while designing levels. Uses
+ * inotify on Linux and polls the modification time elsewhere.
+ * Polled from the main thread; never blocks. */
+class LevelWatcher
+{
+public:
+    LevelWatcher();
+    ~LevelWatcher();
+    
+    /* Starts watching the file at the given absolute path,
+     * replacing any file watched before. */
+    void watch(const std::string path);
+    
+    /* Stops watching. */
+    void stop();
+    
+    /* Returns true once for each time the watched file has been
+     * written since the last call. */
+    bool hasChanged();
+    
+    /* Absolute path of the watched file, or empty. */
+    const std::string& getPath() const;
+    
+private:
+    std::string path;
+    
+#ifdef TARGET_LINUX
+    /* Editors often save by replacing the file, so the directory
+     * is watched and events are filtered by file name. */
+    int inotifyFd = -1;
+    int watchDescriptor = -1;
+    std::string fileName;
+#else
+    /* Seconds between modification time checks. */
+    float pollInterval = 0.25f;
+    float lastPollTime = 0.f;
+    time_t lastModified = 0;
+#endif
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <stddef.h>
+
+/* Read-only memory mapping of a whole file. Pages are loaded
+ * lazily by the OS, so opening a large file is cheap and only
+ * the parts that are read become resident. */
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    /* Maps the file at the given absolute path. Returns false
+     * if the file could not be opened or mapped. */
+    bool open(const std::string path);
+
+    /* Unmaps the file. Pointers into it become invalid. */
+    void close();
+
+    bool isOpen() const;
+
+    /* Start and length of the mapping. */
+    const char* getData() const;
+    size_t getSize() const;
+
+    /* Hints that |length| bytes from |offset| will be read soon, so
+     * the OS starts reading them in. Doesn't wait for the read. */
+    void prefetch(size_t offset, size_t length) const;
+
+private:
+    /* Not copyable; the mapping has a single owner. */
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+    const char* data;
+    size_t size;
+};
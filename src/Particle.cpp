@@ -1,16 +1,19 @@
 #include "Particle.h"
+#include "AssetCache.h"
+#include "WaveRings.h"
+#include "CircleTessellation.h"
+#include "GameClock.h"
+#include "Tunables.h"
 
 #include <assert.h>
+#include <float.h>
 
-#define TIME_SCALE 0.01f
-#define PIXEL_SCALE 10000.f
-#define WAVE_RANGE 200.f
-#define WAVE_RANGE_2 100.f
+/* Ticks per second of particle source emission sequences. */
+#define EMISSION_TICKS_PER_SECOND 1000
 
 ofSoundMixer* SoundSource::sm = NULL;
 ofSoundMixer* SoundParticle::sm = NULL;
 ofSoundMixer* ParticleSink::sm = NULL;
-ofTrueTypeFont ParticleSink::font;
 
 SoundParticle::SoundParticle(float freq) {
     frequency = freq;
@@ -24,18 +27,22 @@ SoundParticle::~SoundParticle() {
     sm->RemoveSource(soundSourceID);
 }
 
-void SoundParticle::setup(b2World *b2dworld, float x, float y, float radius) {
-    ofxBox2dCircle::setup(b2dworld, x, y, radius);
-    
-    // Set sound ID as data so we can fetch and play it later in a
-    // collision callback. See |Level::onContactStart|.
-    setData(&soundSourceID);
-}
-
 float SoundParticle::getFrequency() {
     return frequency;
 }
 
+int SoundParticle::getSoundSourceID() {
+    return soundSourceID;
+}
+
+int SoundParticle::getTrail() {
+    return trail;
+}
+
+void SoundParticle::setTrail(int trail) {
+    this->trail = trail;
+}
+
 ofVec2f SoundParticle::getCurrentPosition() {
     return currentPosition;
 }
@@ -59,12 +66,17 @@ void SoundParticle::draw() {
     ofRotate(getRotation(), 0, 0, 1);
     
     // Draw particle.
-    ofCircle(0, 0, getRadius());
+    CircleTessellation::drawCircle(0, 0, getRadius());
     
     // Undo transforms.
     ofPopMatrix();
 }
 
+void SoundParticle::addToBatch(CircleBatch& batch, ofColor color) {
+    if(!isBody()) return;
+    batch.add(getPosition(), getRadius(), color);
+}
+
 void SoundParticle::Initialize(ofSoundMixer* sm) {
     SoundParticle::sm = sm;
 }
@@ -73,11 +85,11 @@ SoundSource::SoundSource(float freq)
 : frequency(freq) {
     assert(sm != NULL);
     maxAmplitude = 6.f;
-    period = 1.f / frequency;
     
     SMSoundProperties properties;
     properties.freq = frequency;
     properties.volume = 0.f;
+    properties.sample = sm->FindSample("sound");
     soundSourceID = sm->AddSource(properties);
 }
 
@@ -91,19 +103,25 @@ float SoundSource::getFrequency() {
 
 
 bool SoundSource::shouldRepel(SoundParticle& particle) {
-    float distance = getPosition().distance(particle.getPosition());
-    float freqDiff = particle.getFrequency() - frequency;
-    return !(distance > WAVE_RANGE || abs(freqDiff) > 20);
+    return shouldRepel(getPosition(), frequency, particle.getPosition(), particle.getFrequency());
+}
+
+bool SoundSource::shouldRepel(const ofVec2f& center, float frequency,
+                              const ofVec2f& position, float particleFrequency) {
+    float distance = center.distance(position);
+    float freqDiff = particleFrequency - frequency;
+    return !(distance > Tunables::get(Tunables::WAVE_RANGE) || abs(freqDiff) > 20);
 }
 
-void SoundSource::repel(SoundParticle& particle) {
+float SoundSource::repel(SoundParticle& particle) {
     // Get current distance from rim.
+    float waveRange = Tunables::get(Tunables::WAVE_RANGE);
     float distanceFromCenter = getPosition().distance(particle.getCurrentPosition());
-    float distanceFromRim = (WAVE_RANGE - distanceFromCenter) / WAVE_RANGE;
+    float distanceFromRim = (waveRange - distanceFromCenter) / waveRange;
     
     // Get prior distance from rim.
     float priorDistanceFromCenter = getPosition().distance(particle.getPriorPosition());
-    float priorDistanceFromRim = (WAVE_RANGE - priorDistanceFromCenter) / WAVE_RANGE;
+    float priorDistanceFromRim = (waveRange - priorDistanceFromCenter) / waveRange;
     
     if (priorDistanceFromRim > distanceFromRim) {
         particle.addRepulsionForce(getPosition(), 0.06 * frequency * distanceFromRim);
@@ -112,32 +130,23 @@ void SoundSource::repel(SoundParticle& particle) {
         particle.addRepulsionForce(getPosition(), 0.1 * frequency * pow(distanceFromRim, 2));
     }
     sm->Play(soundSourceID, distanceFromRim);
+    return distanceFromRim;
 }
 
 void SoundSource::draw(ofColor color) {
     if(!isBody()) return;
     
+    // Draw waves.
+    WaveRings::draw(getPosition(), getRadius(), frequency, Tunables::get(Tunables::WAVE_RANGE), color);
+    
     // Translate and rotate context to particle position.
     ofPushMatrix();
     ofTranslate(getPosition().x, getPosition().y, 0);
     ofRotate(getRotation(), 0, 0, 1);
     
-    // Draw waves.
-    ofPushStyle();
-    ofNoFill();
-    ofSetLineWidth(3);
-    float offset = fmod(TIME_SCALE * ofGetElapsedTimef(), period);
-    for (float x = offset; x * PIXEL_SCALE < WAVE_RANGE; x += period) {
-        float alpha =  (WAVE_RANGE - x * PIXEL_SCALE) / WAVE_RANGE;
-        ofSetColor(color.r, color.g, color.b, color.a * alpha);
-        ofCircle(0, 0, getRadius() + x * PIXEL_SCALE);
-    }
-    ofCircle(0, 0, getRadius());
-    ofPopStyle();
-    
     // Draw particle.
     ofSetColor(color);
-    ofCircle(0, 0, getRadius());
+    CircleTessellation::drawCircle(0, 0, getRadius());
     
     // Undo transforms.
     ofPopMatrix();
@@ -148,7 +157,7 @@ void SoundSource::Initialize(ofSoundMixer* sm) {
 }
 
 ParticleSource::ParticleSource(std::vector<int> pattern) {
-    frequencyPattern = pattern;
+    setPattern(pattern);
 }
 
 ParticleSource::~ParticleSource() {
@@ -160,22 +169,63 @@ int ParticleSource::getEmissionCount() {
 }
 
 float ParticleSource::getFrequency() {
-    float freq = frequencyPattern[patternIndex];
-    patternIndex++;
-    if (patternIndex >= frequencyPattern.size()) {
-        patternIndex = 0;
+    return frequency;
+}
+
+void ParticleSource::setPattern(const std::vector<int>& pattern) {
+    // Emit one particle per note, starting right away.
+    int64_t interval = emissionFreq * EMISSION_TICKS_PER_SECOND;
+    std::vector<SequenceNote> notes;
+    for (int i = 0; i < pattern.size(); i++) {
+        SequenceNote note = { i * interval, 0, pattern[i], 1.f };
+        notes.push_back(note);
+    }
+    
+    // Carry on from the same point in the new pattern.
+    int64_t position = emissions.getPosition();
+    emissions = Sequence(notes, pattern.size() * interval, true);
+    if (startTime != -1.f) {
+        emissions.seek(position % max(emissions.getLength(), (int64_t)1));
     }
-    return freq;
 }
 
 bool ParticleSource::shouldEmitParticle() {
-    float now = ofGetElapsedTimef();
-    if (now - lastEmissionTime > emissionFreq) {
+    float now = GameClock::getTime();
+    if (startTime == -1.f) {
+        startTime = now;
+    }
+    
+    // Advance to the current game time. Ticks are counted from the
+    // start rather than per frame, so rounding doesn't add up.
+    int64_t target = (now - startTime) * EMISSION_TICKS_PER_SECOND;
+    bool emit = false;
+    emissions.advance(target - elapsed, [&](const SequenceNote& note, bool on) {
+        emit = true;
+        frequency = note.value;
+    });
+    elapsed = target;
+    if (emit) {
         emissionCount++;
-        lastEmissionTime = now;
-        return true;
     }
-    return false;
+    return emit;
+}
+
+float ParticleSource::getNextEmissionTime() {
+    if (startTime == -1.f) {
+        return GameClock::getTime();
+    }
+    int64_t ticks = emissions.getTicksToNextEvent();
+    if (ticks < 0) {
+        return FLT_MAX;
+    }
+    
+    // A note is reached once the game time is past its tick.
+    return startTime + (float)(elapsed + ticks + 1) / EMISSION_TICKS_PER_SECOND;
+}
+
+void ParticleSource::addToBatch(CircleBatch& batch, ofColor color) {
+    if(!isBody()) return;
+    batch.add(getPosition(), 50, color);
 }
 
 void ParticleSource::draw() {
@@ -188,20 +238,19 @@ void ParticleSource::draw() {
     
     // Draw particle.
     ofFill();
-    ofCircle(0, 0, 50);
+    CircleTessellation::drawCircle(0, 0, 50);
     
     // Undo transforms.
     ofPopMatrix();
 }
 
 ParticleSink::ParticleSink(float limit, float freq)
-    : limit(limit), frequency(freq), period(1.f / freq) {
-    if (!font.isLoaded()) {
-        font.loadFont("Kiddish.ttf", 40, true, true);
-    }
+    : limit(limit), frequency(freq) {
+    font = AssetCache::getFont("Kiddish.ttf", 40);
     SMSoundProperties properties;
     properties.freq = frequency;
     properties.volume = 0.f;
+    properties.sample = sm->FindSample("sink");
     soundSourceID = sm->AddSource(properties);
 }
 
@@ -218,6 +267,10 @@ int ParticleSink::getCollectionCount() {
     return collectionCount;
 }
 
+void ParticleSink::setLimit(int limit) {
+    this->limit = limit;
+}
+
 bool ParticleSink::attract(SoundParticle& particle) {
     float distance = getPosition().distance(particle.getPosition());
     if (abs(particle.getFrequency() - frequency) > 20) {
@@ -240,60 +293,59 @@ bool ParticleSink::isFull() {
     return collectionCount >= limit;
 }
 
-void ParticleSink::play() {
-    isPlaying = true;
-    sm->Play(soundSourceID, 1.0);
+int ParticleSink::getSoundSourceID() {
+    return soundSourceID;
 }
 
-void ParticleSink::stop() {
-    isPlaying = false;
-    sm->Play(soundSourceID, 0.0);
+void ParticleSink::setPlaying(bool playing) {
+    isPlaying = playing;
 }
 
 void ParticleSink::draw(ofColor color) {
     if(!isBody()) return;
     
-    // Translate and rotate context to particle position.
+    // Draw waves.
+    drawWaves(color);
+    
+    // Translate context to particle position.
     ofPushMatrix();
     ofTranslate(getPosition().x, getPosition().y, 0);
-    ofRotate(getRotation(), 0, 0, 1);
-    
-    // Draw waves.
-    if (isPlaying) {
-        ofPushStyle();
-        ofNoFill();
-        ofSetLineWidth(3);
-        float offset = fmod(TIME_SCALE * ofGetElapsedTimef(), period);
-        for (float x = offset; x * PIXEL_SCALE < WAVE_RANGE_2; x += period) {
-            float alpha =  (WAVE_RANGE_2 - x * PIXEL_SCALE) / WAVE_RANGE_2;
-            ofSetColor(color.r, color.g, color.b, color.a * alpha);
-            ofCircle(0, 0, getRadius() + x * PIXEL_SCALE);
-        }
-        ofCircle(0, 0, getRadius());
-        ofPopStyle();
-    }
     
     // Draw particle.
     ofPushStyle();
     ofFill();
     ofSetColor(color);
-    ofCircle(0, 0, 50);
+    CircleTessellation::drawCircle(0, 0, 50);
     ofPopStyle();
     
     // Undo transforms.
     ofPopMatrix();
     
     // Draw collection count.
+    drawCount();
+}
+
+void ParticleSink::drawWaves(ofColor color) {
+    if(!isBody() || !isPlaying) return;
+    WaveRings::draw(getPosition(), getRadius(), frequency, Tunables::get(Tunables::SINK_WAVE_RANGE), color);
+}
+
+void ParticleSink::drawCount() {
+    if(!isBody()) return;
+    
     ofPushStyle();
     ofSetColor(255, 255, 255, 255);
-    std::ostringstream buff;
-    buff << (limit - collectionCount);
-    int width = font.stringWidth(buff.str());
-    int height = font.stringHeight(buff.str());
-    font.drawString(buff.str(), getPosition().x - width / 2.f, getPosition().y + height / 2.f);
+    countText.set(font, (int)(limit - collectionCount));
+    countText.draw(getPosition().x - countText.getWidth() / 2.f,
+                   getPosition().y + countText.getHeight() / 2.f);
     ofPopStyle();
 }
 
+void ParticleSink::addToBatch(CircleBatch& batch, ofColor color) {
+    if(!isBody()) return;
+    batch.add(getPosition(), 50, color);
+}
+
 void ParticleSink::Initialize(ofSoundMixer* sm) {
     ParticleSink::sm = sm;
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "ofMain.h"
 #include "ofxBox2d.h"
 #include "ofSoundMixer.h"
+#include "CircleBatch.h"
+#include "CachedText.h"
 
 /* Represents a dynamic on-screen object that moves
  * around based on gravity and forces exerted by other
@@ -13,11 +15,9 @@ public:
     SoundParticle(float freq);
     ~SoundParticle();
     
-    /* Override setup to register audio information. */
-    virtual void setup(b2World * b2dworld, float x, float y, float radius);
-    
     /* Read-only accessors for private properties. */
     float getFrequency();
+    int getSoundSourceID();
     ofVec2f getCurrentPosition();
     ofVec2f getPriorPosition();
     
@@ -25,12 +25,22 @@ public:
     void update();
     virtual void draw();
     
+    /* Adds this particle to a batch of circles to be drawn
+     * together, instead of drawing it right away. */
+    void addToBatch(CircleBatch& batch, ofColor color);
+    
+    /* ID of this particle's motion trail in the level's
+     * |TrailBatch|, or -1 if it has none. */
+    int getTrail();
+    void setTrail(int trail);
+    
     static void Initialize(ofSoundMixer* sm);
     
 private:
     static ofSoundMixer* sm;
     int soundSourceID;
     float frequency;
+    int trail = -1;
     
     ofVec2f currentPosition;
     ofVec2f priorPosition;
@@ -51,10 +61,17 @@ public:
      * sound source's radius of influence. */
     bool shouldRepel(SoundParticle& particle);
     
+    /* Same test for a sound source at |center| of the given
+     * frequency and a particle at |position|, for callers that
+     * keep positions in bulk. */
+    static bool shouldRepel(const ofVec2f& center, float frequency,
+                            const ofVec2f& position, float particleFrequency);
+    
     /* Exerts a force on the particle propertional
      * to its location within this sound source's
-     * radius of influence. */
-    void repel(SoundParticle& particle);
+     * radius of influence. Returns the volume the
+     * sound source now plays at. */
+    float repel(SoundParticle& particle);
     
     /* Standard draw callback. */
     virtual void draw(ofColor color);
@@ -67,7 +84,6 @@ private:
     
     float maxAmplitude;
     float soundRadius;
-    float period;
     float frequency;
 };
 
@@ -82,21 +98,35 @@ public:
     int getEmissionCount();
     float getFrequency();
     
+    /* Replaces the emission pattern. */
+    void setPattern(const std::vector<int>& pattern);
+    
     /* Returns true if this particle source should
-     * emit a particle again, i.e. interval since
-     * last emission is longer than emission frequency. */
+     * emit a particle again, i.e. the emission pattern
+     * has reached its next note. |getFrequency| then
+     * returns the note's frequency. */
     bool shouldEmitParticle();
     
+    /* Game time at which |shouldEmitParticle| will next return
+     * true, or FLT_MAX if it never will. */
+    float getNextEmissionTime();
+    
     /* Standard draw callback. */
     virtual void draw();
     
+    /* Adds the emitter body to a batch of circles. */
+    void addToBatch(CircleBatch& batch, ofColor color);
+    
 private:
     float emissionFreq = 3;
-    float lastEmissionTime = 0;
-    int emissionCount;
-    
-    int patternIndex = 0;
-    std::vector<int> frequencyPattern;
+    int emissionCount = 0;
+    
+    /* The pattern as a looping sequence in milliseconds of game
+     * time, with the frequency of the last note that started. */
+    Sequence emissions;
+    float startTime = -1.f;
+    int64_t elapsed = 0;
+    int frequency = 0;
 };
 
 /* Represents a particle sink. Absorbs particle within
@@ -110,6 +140,9 @@ public:
     float getFrequency();
     int getCollectionCount();
     
+    /* Changes the sink capacity. */
+    void setLimit(int limit);
+    
     /* Attracts a nearby moving particle. Returns true
      * if the particle reaches the sink's location. */
     bool attract(SoundParticle& particle);
@@ -118,13 +151,23 @@ public:
      * collection count == sink capacity (limit). */
     bool isFull();
     
-    /* Plays this particle sink's collection pitch. */
-    void play();
-    void stop();
+    /* Mixer source of this particle sink's collection pitch. */
+    int getSoundSourceID();
+    
+    /* Set while the level preview plays the collection pitch, to
+     * show the sink's waves. */
+    void setPlaying(bool playing);
     
     /* Standard draw callback. */
     virtual void draw(ofColor color);
     
+    /* Draws the parts of the sink separately, so the body can be
+     * batched with other circles. Waves go below the body and the
+     * remaining count on top of it. */
+    void drawWaves(ofColor color);
+    void addToBatch(CircleBatch& batch, ofColor color);
+    void drawCount();
+    
     static void Initialize(ofSoundMixer* sm);
     
 private:
@@ -132,12 +175,12 @@ private:
     int soundSourceID;
     bool isPlaying = false;
     
-    static ofTrueTypeFont font;
+    std::shared_ptr<ofTrueTypeFont> font;
+    CachedText countText;
     
     int collectionCount = 0;
     
     float sinkRadius = 100;
     float limit = 10;
     float frequency;
-    float period;
 };
\ No newline at end of file
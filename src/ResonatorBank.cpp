@@ -0,0 +1,154 @@
+#include "ResonatorBank.h"
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define RESONATOR_SSE 1
+#endif
+
+/* Strikes quieter than this are silent and stop ringing. */
+#define SILENCE 1e-4f
+
+/* Modes are kept below this fraction of the sample rate. */
+#define MAX_MODE_FREQ 0.45f
+
+struct ModeSet {
+    float ratios[MODES_PER_STRIKE];
+    float decays[MODES_PER_STRIKE]; /* Seconds to fall by 60dB. */
+    float gains[MODES_PER_STRIKE];
+};
+
+/* Mode sets, in |ResonatorMaterial| order. */
+static const ModeSet MODE_SETS[] = {
+    // A taut wire: nearly harmonic and long.
+    { { 1.f, 2.f, 3.01f, 4.03f }, { 1.2f, 0.8f, 0.5f, 0.3f }, { 0.5f, 0.25f, 0.15f, 0.1f } },
+    // A wooden block: inharmonic and short.
+    { { 1.f, 2.57f, 4.21f, 6.33f }, { 0.12f, 0.08f, 0.05f, 0.03f }, { 0.6f, 0.25f, 0.1f, 0.05f } },
+    // A small free bar, like a glockenspiel key.
+    { { 1.f, 2.756f, 5.404f, 8.933f }, { 0.6f, 0.35f, 0.2f, 0.1f }, { 0.5f, 0.3f, 0.15f, 0.05f } },
+};
+
+ResonatorBank::ResonatorBank(float sampleRate)
+: sampleRate(sampleRate) {
+    memset(ringing, 0, sizeof(ringing));
+    memset(b1, 0, sizeof(b1));
+    memset(b2, 0, sizeof(b2));
+    memset(y1, 0, sizeof(y1));
+    memset(y2, 0, sizeof(y2));
+}
+
+void ResonatorBank::strike(ResonatorMaterial material, float freq, float strength) {
+    // Take the next silent strike, or else replace the oldest one.
+    int index = nextStrike;
+    for (int i = 0; i < RESONATOR_STRIKES; i++) {
+        int candidate = (nextStrike + i) % RESONATOR_STRIKES;
+        if (!ringing[candidate]) {
+            index = candidate;
+            break;
+        }
+    }
+    nextStrike = (index + 1) % RESONATOR_STRIKES;
+    if (!ringing[index]) {
+        ringing[index] = true;
+        ringingCount++;
+    }
+    
+    const ModeSet& modes = MODE_SETS[material];
+    for (int i = 0; i < MODES_PER_STRIKE; i++) {
+        int mode = index * MODES_PER_STRIKE + i;
+        float modeFreq = freq * modes.ratios[i];
+        if (modeFreq <= 0.f || modeFreq >= MAX_MODE_FREQ * sampleRate) {
+            b1[mode] = b2[mode] = y1[mode] = y2[mode] = 0.f;
+            continue;
+        }
+        
+        // Pole radius for the decay time, angle for the frequency.
+        float radius = expf(-6.908f / (modes.decays[i] * sampleRate));
+        float angle = 2.f * M_PI * modeFreq / sampleRate;
+        b1[mode] = 2.f * radius * cosf(angle);
+        b2[mode] = -radius * radius;
+        
+        // Starting from y[-1] = a sin(w) and y[-2] = 0 rings as a
+        // decaying sine of amplitude a, with no click.
+        y1[mode] = strength * modes.gains[i] * sinf(angle);
+        y2[mode] = 0.f;
+    }
+}
+
+void ResonatorBank::process(float* output, int frames) {
+    for (int start = 0; start < frames; start += RESONATOR_BLOCK) {
+        int count = frames - start < RESONATOR_BLOCK ? frames - start : RESONATOR_BLOCK;
+        processBlock(output + start, count);
+    }
+}
+
+int ResonatorBank::getRingingCount() const {
+    return ringingCount;
+}
+
+void ResonatorBank::processBlock(float* output, int frames) {
+    if (ringingCount == 0) {
+        return;
+    }
+    memset(mix, 0, frames * MODES_PER_STRIKE * sizeof(float));
+    
+    for (int i = 0; i < RESONATOR_STRIKES; i++) {
+        if (!ringing[i]) {
+            continue;
+        }
+        float* modeB1 = b1 + i * MODES_PER_STRIKE;
+        float* modeB2 = b2 + i * MODES_PER_STRIKE;
+        float* modeY1 = y1 + i * MODES_PER_STRIKE;
+        float* modeY2 = y2 + i * MODES_PER_STRIKE;
+        float peak = 0.f;
+#ifdef RESONATOR_SSE
+        // All modes of the strike at once, kept in registers for the block.
+        __m128 vb1 = _mm_load_ps(modeB1);
+        __m128 vb2 = _mm_load_ps(modeB2);
+        __m128 vy1 = _mm_load_ps(modeY1);
+        __m128 vy2 = _mm_load_ps(modeY2);
+        __m128 signMask = _mm_set1_ps(-0.f);
+        __m128 vpeak = _mm_setzero_ps();
+        for (int n = 0; n < frames; n++) {
+            __m128 y = _mm_add_ps(_mm_mul_ps(vb1, vy1), _mm_mul_ps(vb2, vy2));
+            vy2 = vy1;
+            vy1 = y;
+            vpeak = _mm_max_ps(vpeak, _mm_andnot_ps(signMask, y));
+            float* frame = mix + n * MODES_PER_STRIKE;
+            _mm_store_ps(frame, _mm_add_ps(_mm_load_ps(frame), y));
+        }
+        _mm_store_ps(modeY1, vy1);
+        _mm_store_ps(modeY2, vy2);
+        alignas(16) float peaks[MODES_PER_STRIKE];
+        _mm_store_ps(peaks, vpeak);
+        for (int j = 0; j < MODES_PER_STRIKE; j++) {
+            peak = fmaxf(peak, peaks[j]);
+        }
+#else
+        for (int n = 0; n < frames; n++) {
+            float* frame = mix + n * MODES_PER_STRIKE;
+            for (int j = 0; j < MODES_PER_STRIKE; j++) {
+                float y = modeB1[j] * modeY1[j] + modeB2[j] * modeY2[j];
+                modeY2[j] = modeY1[j];
+                modeY1[j] = y;
+                frame[j] += y;
+                peak = fmaxf(peak, fabsf(y));
+            }
+        }
+#endif
+        
+        // A block spans enough of a period to see the amplitude. Stop
+        // before the state decays into denormals.
+        if (peak < SILENCE) {
+            ringing[i] = false;
+            ringingCount--;
+        }
+    }
+    
+    for (int n = 0; n < frames; n++) {
+        const float* frame = mix + n * MODES_PER_STRIKE;
+        output[n] += frame[0] + frame[1] + frame[2] + frame[3];
+    }
+}
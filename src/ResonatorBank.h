@@ -0,0 +1,58 @@
+#pragma once
+
+/* Materials of struck surfaces. Each has its own set of modes. */
+typedef enum {
+    LINE_MATERIAL = 0,
+    BOX_MATERIAL,
+    PARTICLE_MATERIAL,
+} ResonatorMaterial;
+
+/* Number of modes rung by one strike, i.e. one SIMD vector. */
+#define MODES_PER_STRIKE 4
+
+/* Strikes that can ring at the same time. */
+#define RESONATOR_STRIKES 256
+
+/* Most frames rendered per pass. Longer blocks take several passes. */
+#define RESONATOR_BLOCK 256
+
+/* A bank of damped two-pole resonators for contact sounds. A strike
+ * rings the four modes of its material at once; the modes of one
+ * strike sit side by side in structure-of-arrays state, so each
+ * strike is a single SSE vector, and strikes that have decayed to
+ * silence are skipped. Platforms without SSE use a scalar loop.
+ * Nothing is allocated after construction, so the bank can be used
+ * from the audio callback. Doesn't depend on openFrameworks. */
+class ResonatorBank
+{
+public:
+    ResonatorBank(float sampleRate);
+    
+    /* Rings the modes of |material| with |freq| as the lowest mode.
+     * |strength| is the peak amplitude, from 0 to 1. If every strike
+     * is ringing, the one struck longest ago is replaced. */
+    void strike(ResonatorMaterial material, float freq, float strength);
+    
+    /* Adds |frames| samples of the ringing strikes to |output|. */
+    void process(float* output, int frames);
+    
+    /* Number of strikes still ringing. */
+    int getRingingCount() const;
+    
+private:
+    void processBlock(float* output, int frames);
+    
+    float sampleRate;
+    int nextStrike = 0;
+    int ringingCount = 0;
+    bool ringing[RESONATOR_STRIKES];
+    
+    /* Per mode: y[n] = b1 * y[n-1] + b2 * y[n-2]. */
+    alignas(16) float b1[RESONATOR_STRIKES * MODES_PER_STRIKE];
+    alignas(16) float b2[RESONATOR_STRIKES * MODES_PER_STRIKE];
+    alignas(16) float y1[RESONATOR_STRIKES * MODES_PER_STRIKE];
+    alignas(16) float y2[RESONATOR_STRIKES * MODES_PER_STRIKE];
+    
+    /* The modes of all strikes summed per frame, one vector each. */
+    alignas(16) float mix[RESONATOR_BLOCK * MODES_PER_STRIKE];
+};
@@ -0,0 +1,94 @@
+#include "SampleBank.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string.h>
+
+bool SampleBank::open(const std::string path) {
+    close();
+    if (!file.open(path)) {
+        return false;
+    }
+
+    // Check the header before trusting any offsets in it.
+    if (file.getSize() < sizeof(SampleBankHeader)) {
+        std::cerr << "Sample bank is truncated: " << path << std::endl;
+        close();
+        return false;
+    }
+    const SampleBankHeader* candidate = (const SampleBankHeader *)file.getData();
+    if (candidate->magic != SAMPLE_BANK_MAGIC || candidate->version != SAMPLE_BANK_VERSION) {
+        std::cerr << "Not a version " << SAMPLE_BANK_VERSION << " sample bank: " << path << std::endl;
+        close();
+        return false;
+    }
+    bool valid = candidate->samplesOffset % 4 == 0 &&
+                 validRange(candidate->samplesOffset, (uint64_t)candidate->sampleCount * sizeof(SampleBankSample)) &&
+                 validRange(candidate->stringsOffset, candidate->stringsSize);
+
+    // Names must be terminated within the string table, and PCM data
+    // must lie within the file, so playback never checks again.
+    const SampleBankSample* records = (const SampleBankSample *)(file.getData() + candidate->samplesOffset);
+    const char* strings = file.getData() + candidate->stringsOffset;
+    for (uint32_t i = 0; valid && i < candidate->sampleCount; i++) {
+        const SampleBankSample& sample = records[i];
+        valid = sample.name < candidate->stringsSize &&
+                memchr(strings + sample.name, '\0', candidate->stringsSize - sample.name) &&
+                sample.dataOffset % 4 == 0 &&
+                validRange(sample.dataOffset, (uint64_t)sample.frameCount * sizeof(int16_t)) &&
+                sample.frameCount > 0 && sample.sampleRate > 0 && sample.rootFrequency > 0 &&
+                sample.loopEnd <= sample.frameCount;
+    }
+    if (!valid) {
+        std::cerr << "Sample bank is corrupt: " << path << std::endl;
+        close();
+        return false;
+    }
+    header = candidate;
+    samples = records;
+    return true;
+}
+
+void SampleBank::close() {
+    header = NULL;
+    samples = NULL;
+    file.close();
+}
+
+bool SampleBank::isOpen() const {
+    return header != NULL;
+}
+
+int SampleBank::getSampleCount() const {
+    return header ? header->sampleCount : 0;
+}
+
+int SampleBank::find(const std::string name) const {
+    for (int i = 0; i < getSampleCount(); i++) {
+        if (name == file.getData() + header->stringsOffset + samples[i].name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const SampleBankSample& SampleBank::getSample(int index) const {
+    return samples[index];
+}
+
+const int16_t* SampleBank::getFrames(int index) const {
+    return (const int16_t *)(file.getData() + samples[index].dataOffset);
+}
+
+void SampleBank::prefetch(int index, uint32_t frame, uint32_t frameCount) const {
+    const SampleBankSample& sample = samples[index];
+    if (frame >= sample.frameCount) {
+        return;
+    }
+    frameCount = std::min(frameCount, sample.frameCount - frame);
+    file.prefetch(sample.dataOffset + (size_t)frame * sizeof(int16_t), (size_t)frameCount * sizeof(int16_t));
+}
+
+bool SampleBank::validRange(uint64_t offset, uint64_t size) const {
+    return offset + size <= file.getSize();
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "SampleBankFormat.h"
+#include "MappedFile.h"
+
+/* A sample bank, memory-mapped and played in place. See
+ * SampleBankFormat.h for the layout. PCM data is only read from
+ * disk as it is played, and every voice playing a sample shares
+ * the same pages, so neither loading nor adding voices costs
+ * resident memory per instance. */
+class SampleBank
+{
+public:
+    /* Maps and validates the bank at the given absolute path.
+     * Returns false if the file is missing or malformed. */
+    bool open(const std::string path);
+    void close();
+    bool isOpen() const;
+
+    /* Number of samples in the bank. */
+    int getSampleCount() const;
+
+    /* Index of the sample called |name|, or -1 if there is none. */
+    int find(const std::string name) const;
+
+    /* Record of the sample at |index|, which must be in range. */
+    const SampleBankSample& getSample(int index) const;
+
+    /* PCM frames of the sample at |index|. */
+    const int16_t* getFrames(int index) const;
+
+    /* Asks the OS to start reading |frameCount| frames from |frame|
+     * of the sample at |index| into memory, without waiting. Lets
+     * long samples stream ahead of playback instead of faulting
+     * pages in on the audio thread. */
+    void prefetch(int index, uint32_t frame, uint32_t frameCount) const;
+
+private:
+    /* Returns true if |size| bytes at |offset| lie within the mapping. */
+    bool validRange(uint64_t offset, uint64_t size) const;
+
+    MappedFile file;
+    const SampleBankHeader* header = NULL;
+    const SampleBankSample* samples = NULL;
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+
+/* On-disk layout of a sample bank: recorded sounds decoded ahead of
+ * time to 16-bit mono PCM, so the mixer can memory-map the bank and
+ * play straight out of the mapping. A bank is a header, an array of
+ * sample records, a string table with the sample names, and the PCM
+ * data of each sample. All offsets are in bytes from the start of
+ * the file, the records and PCM data are 4-byte aligned, and values
+ * are stored in host byte order. Build banks with tools/samplebank. */
+
+#define SAMPLE_BANK_MAGIC 0x42535353 /* "SSSB" */
+#define SAMPLE_BANK_VERSION 1
+
+struct SampleBankHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t samplesOffset, sampleCount;
+    uint32_t stringsOffset, stringsSize;
+};
+
+/* One recorded sound. It plays at |rootFrequency| when not
+ * resampled. If |loopEnd| is past |loopStart|, frames from
+ * |loopStart| up to |loopEnd| repeat for as long as the voice
+ * sounds; otherwise the sample plays once. */
+struct SampleBankSample {
+    uint32_t name; /* Offset into the string table. */
+    uint32_t dataOffset, frameCount;
+    uint32_t sampleRate;
+    float rootFrequency;
+    uint32_t loopStart, loopEnd;
+};
@@ -0,0 +1,66 @@
+#include "Sequence.h"
+
+#include <algorithm>
+
+Sequence::Sequence() {
+}
+
+Sequence::Sequence(const std::vector<SequenceNote>& notes, int64_t length, bool loop)
+: notes(notes), length(length), loop(loop), finished(false) {
+    for (int i = 0; i < notes.size(); i++) {
+        int64_t start = std::max((int64_t)0, std::min(notes[i].start, length));
+        int64_t stop = std::max(start, std::min(notes[i].start + notes[i].length, length));
+        Event on = { start, true, i };
+        events.push_back(on);
+        if (stop > start) {
+            Event off = { stop, false, i };
+            events.push_back(off);
+        }
+    }
+    std::stable_sort(events.begin(), events.end());
+}
+
+int64_t Sequence::getPosition() const {
+    return position;
+}
+
+int64_t Sequence::getLength() const {
+    return length;
+}
+
+const std::vector<SequenceNote>& Sequence::getNotes() const {
+    return notes;
+}
+
+bool Sequence::isFinished() const {
+    return finished;
+}
+
+int64_t Sequence::getTicksToNextEvent() const {
+    if (finished || events.empty()) {
+        return -1;
+    }
+    if (next < events.size()) {
+        return events[next].time - position;
+    }
+    if (loop && length > 0) {
+        return length - position + events[0].time;
+    }
+    return -1;
+}
+
+void Sequence::seek(int64_t position) {
+    this->position = std::max((int64_t)0, std::min(position, length));
+    next = 0;
+    while (next < events.size() && events[next].time < this->position) {
+        next++;
+    }
+    finished = false;
+}
+
+bool Sequence::Event::operator<(const Event& other) const {
+    if (time != other.time) {
+        return time < other.time;
+    }
+    return !on && other.on;
+}
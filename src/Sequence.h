@@ -0,0 +1,94 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+/* A note on a |Sequence| timeline. What |value| means is up to
+ * whoever plays the sequence, e.g. a mixer source ID or a pitch. */
+struct SequenceNote {
+    int64_t start;
+    int64_t length;
+    int value;
+    float volume;
+};
+
+/* A timeline of notes that plays through once or loops. Times are
+ * in ticks of whatever clock advances the sequence: the mixer uses
+ * samples, so notes start and stop on exact samples, and particle
+ * sources use milliseconds of game time. Advancing never allocates,
+ * so sequences can be played from the audio callback. Doesn't
+ * depend on openFrameworks. */
+class Sequence
+{
+public:
+    /* An empty sequence, which is finished. */
+    Sequence();
+    
+    /* Notes outside of |length| ticks are clamped to it, and notes
+     * of zero length only start. If |loop| is set, the sequence
+     * starts over after |length| ticks. */
+    Sequence(const std::vector<SequenceNote>& notes, int64_t length, bool loop);
+    
+    /* Ticks since the start of the current pass. */
+    int64_t getPosition() const;
+    int64_t getLength() const;
+    const std::vector<SequenceNote>& getNotes() const;
+    
+    /* True once a sequence that doesn't loop has played through. */
+    bool isFinished() const;
+    
+    /* Ticks from the current position until the next note starts or
+     * stops, or -1 if no more will. */
+    int64_t getTicksToNextEvent() const;
+    
+    /* Jumps to |position| in the current pass. Events in between
+     * are skipped. */
+    void seek(int64_t position);
+    
+    /* Advances by |ticks|, calling |handler(note, on)| for every note
+     * that starts (|on| is true) or stops on the way, in order. Notes
+     * that stop at a tick are handled before ones that start at it. */
+    template <class Handler>
+    void advance(int64_t ticks, Handler handler) {
+        int64_t end = position + ticks;
+        while (!finished) {
+            while (next < events.size() && events[next].time < end) {
+                const Event& event = events[next];
+                handler(notes[event.note], event.on);
+                next++;
+            }
+            if (end <= length) {
+                position = end;
+                return;
+            }
+            
+            // Past the end of the pass. Events at its very end have
+            // fired above, at the same tick as the next pass starts.
+            if (!loop || length <= 0) {
+                position = length;
+                finished = true;
+                return;
+            }
+            end -= length;
+            position = 0;
+            next = 0;
+        }
+    }
+    
+private:
+    /* Start or stop of a note, sorted by time. */
+    struct Event {
+        int64_t time;
+        bool on;
+        int note;
+        bool operator<(const Event& other) const;
+    };
+    
+    std::vector<SequenceNote> notes;
+    std::vector<Event> events;
+    int64_t length = 0;
+    bool loop = false;
+    int64_t position = 0;
+    int next = 0;
+    bool finished = true;
+};
@@ -0,0 +1,112 @@
+#include "Session.h"
+
+#include <iostream>
+#include <sstream>
+#include <limits>
+
+const static std::string SESSION("session");
+
+/* One letter per event type, in |SessionEvent::Type| order. */
+const static char EVENT_CODES[] = { 'k', 'u', 'm', 'p', 'd', 'r', 'w' };
+const static char FRAME_CODE = 'f';
+
+bool Session::loadFromFile(const std::string path) {
+    std::ifstream in(path.c_str());
+    if (!in) {
+        std::cerr << "Could not open session file " << path << std::endl;
+        return false;
+    }
+    
+    std::string prefix;
+    in >> prefix >> seed;
+    frames.clear();
+    
+    // Older sessions have no window size.
+    std::string line;
+    std::getline(in, line);
+    std::istringstream header(line);
+    if (!(header >> width >> height)) {
+        width = height = 0;
+    }
+    
+    while (std::getline(in, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        
+        std::istringstream ss(line);
+        char code;
+        ss >> code;
+        if (code == FRAME_CODE) {
+            SessionFrame frame;
+            ss >> frame.time;
+            frames.push_back(frame);
+            continue;
+        }
+        if (frames.empty()) {
+            continue;
+        }
+        
+        SessionEvent event = SessionEvent();
+        int type = 0;
+        while (type < sizeof(EVENT_CODES) && EVENT_CODES[type] != code) {
+            type++;
+        }
+        if (type == sizeof(EVENT_CODES)) {
+            continue;
+        }
+        event.type = (SessionEvent::Type)type;
+        if (event.type == SessionEvent::KEY_PRESSED || event.type == SessionEvent::KEY_RELEASED) {
+            ss >> event.key;
+        }
+        else {
+            ss >> event.x >> event.y >> event.button;
+        }
+        frames.back().events.push_back(event);
+    }
+    return true;
+}
+
+bool SessionRecorder::open(const std::string path, unsigned int seed, int width, int height) {
+    close();
+    out.open(path.c_str());
+    if (!out) {
+        std::cerr << "Could not create session file " << path << std::endl;
+        return false;
+    }
+    
+    // Enough digits for times to read back as the same float.
+    out.precision(std::numeric_limits<float>::digits10 + 3);
+    out << SESSION << " " << seed << " " << width << " " << height << std::endl;
+    return true;
+}
+
+void SessionRecorder::close() {
+    if (out.is_open()) {
+        out.close();
+    }
+}
+
+bool SessionRecorder::isOpen() const {
+    return out.is_open();
+}
+
+void SessionRecorder::frame(float time) {
+    if (isOpen()) {
+        out << FRAME_CODE << " " << time << "\n";
+    }
+}
+
+void SessionRecorder::event(const SessionEvent& event) {
+    if (!isOpen()) {
+        return;
+    }
+    out << EVENT_CODES[event.type];
+    if (event.type == SessionEvent::KEY_PRESSED || event.type == SessionEvent::KEY_RELEASED) {
+        out << " " << event.key;
+    }
+    else {
+        out << " " << event.x << " " << event.y << " " << event.button;
+    }
+    out << std::endl;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+/* A recorded play session. The game clock is stored for every update
+ * frame, together with the input received after that frame. Physics
+ * steps once per update and game logic reads the time from
+ * |GameClock|, so replaying the same input at the same clock times
+ * reproduces the session exactly. Doesn't depend on openFrameworks.
+ *
+ * Sessions are text files. The first line is
+ * "session <seed> <width> <height>" with the seed for generated
+ * levels and the window size at the start, followed by one line per
+ * frame or event:
+ *   f <time>              start of an update frame
+ *   k <key>, u <key>      key pressed, released
+ *   m <x> <y>             mouse moved
+ *   p|d|r <x> <y> <btn>   mouse pressed, dragged, released
+ *   w <width> <height> 0  window resized
+ * The window size matters because particles leaving the window are
+ * removed. */
+struct SessionEvent {
+    enum Type {
+        KEY_PRESSED,
+        KEY_RELEASED,
+        MOUSE_MOVED,
+        MOUSE_PRESSED,
+        MOUSE_DRAGGED,
+        MOUSE_RELEASED,
+        WINDOW_RESIZED
+    };
+    
+    Type type;
+    int key;
+    float x, y;
+    int button;
+};
+
+struct SessionFrame {
+    float time;
+    std::vector<SessionEvent> events;
+};
+
+class Session
+{
+public:
+    unsigned int seed = 0;
+    
+    /* Window size at the start, or 0 for sessions recorded before
+     * it was. */
+    int width = 0, height = 0;
+    std::vector<SessionFrame> frames;
+    
+    /* Loads a session file from an absolute path. Events before
+     * the first frame are dropped. Returns false if the file could
+     * not be opened. */
+    bool loadFromFile(const std::string path);
+};
+
+/* Writes a session file as the game is played. Lines are written
+ * as they happen, so a session survives the game crashing. */
+class SessionRecorder
+{
+public:
+    /* Starts a new session file at the given absolute path. Returns
+     * false if the file could not be created. */
+    bool open(const std::string path, unsigned int seed, int width, int height);
+    void close();
+    bool isOpen() const;
+    
+    /* Starts a frame at the given game clock time. */
+    void frame(float time);
+    
+    /* Records an input event in the current frame. */
+    void event(const SessionEvent& event);
+    
+private:
+    std::ofstream out;
+};
@@ -0,0 +1,85 @@
+#include "StressLevel.h"
+
+#include <random>
+#include <sstream>
+
+/* Levels are laid out for the default window size. */
+#define LEVEL_WIDTH 1024.f
+#define LEVEL_HEIGHT 768.f
+
+/* Distance kept from the window edges. */
+#define MARGIN 50.f
+
+static const int FREQUENCIES[] = { 440, 660, 880 };
+static const int FREQUENCY_COUNT = sizeof(FREQUENCIES) / sizeof(FREQUENCIES[0]);
+
+void StressLevel::generate(const StressParameters& parameters, unsigned int seed, LevelDescription& description) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> x(MARGIN, LEVEL_WIDTH - MARGIN);
+
+    description.clear();
+    std::ostringstream title;
+    title << "Stress: " << parameters.sources << " sources, " << parameters.sounds << " sounds, "
+          << parameters.boxes << " boxes, " << parameters.sinks << " sinks";
+    description.title = title.str();
+
+    // Sources along the top, emitting a random pattern.
+    std::uniform_real_distribution<float> sourceY(MARGIN, 200.f);
+    std::vector<int> emitted;
+    for (int i = 0; i < parameters.sources; i++) {
+        SourceDescription source;
+        source.x = x(random);
+        source.y = sourceY(random);
+        for (int j = 0; j < parameters.patternLength; j++) {
+            source.pattern.push_back(FREQUENCIES[random() % FREQUENCY_COUNT]);
+            emitted.push_back(source.pattern.back());
+        }
+        description.sources.push_back(source);
+    }
+
+    // Sinks along the bottom, at frequencies the sources emit, so
+    // they can fill up. Without any, sinks get any frequency.
+    std::uniform_real_distribution<float> sinkY(550.f, LEVEL_HEIGHT - MARGIN);
+    for (int i = 0; i < parameters.sinks; i++) {
+        SinkDescription sink;
+        sink.x = x(random);
+        sink.y = sinkY(random);
+        if (emitted.empty()) {
+            sink.freq = FREQUENCIES[random() % FREQUENCY_COUNT];
+        }
+        else {
+            sink.freq = emitted[random() % emitted.size()];
+        }
+        sink.limit = 3 + random() % 3;
+        description.sinks.push_back(sink);
+    }
+
+    // Sound circles and boxes in between. Boxes are small, so that
+    // thousands of them leave room for particles to fall through.
+    std::uniform_real_distribution<float> middleY(200.f, 550.f);
+    for (int i = 0; i < parameters.sounds; i++) {
+        SoundDescription sound;
+        sound.x = x(random);
+        sound.y = middleY(random);
+        sound.freq = FREQUENCIES[random() % FREQUENCY_COUNT];
+        description.sounds.push_back(sound);
+    }
+    std::uniform_real_distribution<float> size(5.f, 40.f);
+    for (int i = 0; i < parameters.boxes; i++) {
+        BoxDescription box;
+        box.x = x(random);
+        box.y = middleY(random);
+        box.width = size(random);
+        box.height = size(random);
+        description.boxes.push_back(box);
+    }
+}
+
+StressParameters StressLevel::scale(const StressParameters& parameters, int factor) {
+    StressParameters scaled = parameters;
+    scaled.sources *= factor;
+    scaled.sounds *= factor;
+    scaled.boxes *= factor;
+    scaled.sinks *= factor;
+    return scaled;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "LevelDescription.h"
+
+/* Object counts of a stress level. */
+struct StressParameters {
+    int sources = 1;
+
+    /* Notes in each source's emission pattern. */
+    int patternLength = 1;
+
+    int sounds = 0;
+    int boxes = 0;
+    int sinks = 1;
+};
+
+/* Generates levels with given numbers of objects, up to the
+ * thousands, to find where the game stops scaling. Unlike
+ * |LevelGenerator| the levels don't have to be solvable, only
+ * valid: sources along the top, sinks along the bottom, sound
+ * circles and small boxes in between, all inside the default
+ * window. Doesn't depend on openFrameworks, so tools/stresslevels
+ * can write them as level files. */
+class StressLevel
+{
+public:
+    /* Fills |description| with a level of the given counts. The
+     * same seed always produces the same level. */
+    static void generate(const StressParameters& parameters, unsigned int seed, LevelDescription& description);
+
+    /* |parameters| with every count but the pattern length
+     * multiplied by |factor|, for sweeping. */
+    static StressParameters scale(const StressParameters& parameters, int factor);
+};
@@ -0,0 +1,162 @@
+#include "Telemetry.h"
+#include "Allocations.h"
+
+#include <fstream>
+#include <iomanip>
+
+/* Column names, in |Telemetry::Counter| order. */
+static const char* COUNTER_NAMES[] = {
+    "particles",
+    "voices",
+    "contacts",
+    "repel_tests",
+    "attract_tests",
+    "physics_us",
+    "draw_us",
+    "allocations"
+};
+
+/* Line height of the bitmap font used by the HUD. */
+#define HUD_LINE_HEIGHT 14
+
+bool Telemetry::enabled = false;
+Telemetry::Frame Telemetry::current = Telemetry::Frame();
+std::vector<Telemetry::Frame> Telemetry::frames;
+Telemetry::Histogram Telemetry::histograms[COUNTER_COUNT];
+uint64_t Telemetry::lastAllocationCount = 0;
+
+void Telemetry::setEnabled(bool enabled) {
+    Telemetry::enabled = enabled;
+    lastAllocationCount = Allocations::getCount();
+}
+
+bool Telemetry::isEnabled() {
+    return enabled;
+}
+
+void Telemetry::add(Counter counter, int amount) {
+    current[counter] += amount;
+}
+
+void Telemetry::set(Counter counter, int value) {
+    current[counter] = value;
+}
+
+void Telemetry::endFrame() {
+    if (enabled) {
+        uint64_t allocationCount = Allocations::getCount();
+        current[ALLOCATIONS] = allocationCount - lastAllocationCount;
+        lastAllocationCount = allocationCount;
+        
+        frames.push_back(current);
+        for (int i = 0; i < COUNTER_COUNT; i++) {
+            histograms[i].add(current[i]);
+        }
+    }
+    current.fill(0);
+}
+
+void Telemetry::endLevel(const std::string path) {
+    if (enabled && !frames.empty()) {
+        std::ofstream out(path.c_str());
+        out << "frame";
+        for (int i = 0; i < COUNTER_COUNT; i++) {
+            out << "," << COUNTER_NAMES[i];
+        }
+        out << "\n";
+        for (int i = 0; i < frames.size(); i++) {
+            out << i;
+            for (int j = 0; j < COUNTER_COUNT; j++) {
+                out << "," << frames[i][j];
+            }
+            out << "\n";
+        }
+        
+        ofLogNotice("Telemetry") << "Saved " << frames.size() << " frames to " << path;
+        for (int i = 0; i < COUNTER_COUNT; i++) {
+            ofLogNotice("Telemetry") << COUNTER_NAMES[i]
+                                     << " p50 " << histograms[i].getPercentile(0.5f)
+                                     << " p95 " << histograms[i].getPercentile(0.95f)
+                                     << " p99 " << histograms[i].getPercentile(0.99f);
+        }
+    }
+    
+    frames.clear();
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        histograms[i].clear();
+    }
+}
+
+void Telemetry::drawHud(float x, float y) {
+    ofPushStyle();
+    ofSetColor(255, 255, 255, 255);
+    std::ostringstream ss;
+    ss << "                now   p50   p95   p99";
+    ofDrawBitmapString(ss.str(), x, y + HUD_LINE_HEIGHT);
+    
+    // Show the last finished frame, since the current one is partial.
+    const Frame& last = frames.empty() ? current : frames.back();
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        ss.str("");
+        ss << std::left << std::setw(14) << COUNTER_NAMES[i] << std::right
+           << std::setw(6) << last[i]
+           << std::setw(6) << histograms[i].getPercentile(0.5f)
+           << std::setw(6) << histograms[i].getPercentile(0.95f)
+           << std::setw(6) << histograms[i].getPercentile(0.99f);
+        ofDrawBitmapString(ss.str(), x, y + (i + 2) * HUD_LINE_HEIGHT);
+    }
+    ofPopStyle();
+}
+
+float Telemetry::getHudHeight() {
+    return (COUNTER_COUNT + 1) * HUD_LINE_HEIGHT;
+}
+
+Telemetry::Histogram::Histogram() {
+    clear();
+}
+
+void Telemetry::Histogram::add(int value) {
+    counts[getBucket(std::max(value, 0))]++;
+    total++;
+}
+
+void Telemetry::Histogram::clear() {
+    std::fill(counts, counts + BUCKETS, 0);
+    total = 0;
+}
+
+int Telemetry::Histogram::getPercentile(float fraction) const {
+    if (total == 0) {
+        return 0;
+    }
+    int rank = (int)ceil(fraction * total);
+    int seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return getBucketStart(i);
+        }
+    }
+    return getBucketStart(BUCKETS - 1);
+}
+
+int Telemetry::Histogram::getBucket(int value) {
+    if (value < 8) {
+        return value;
+    }
+    
+    // Highest set bit, then the next two bits below it.
+    int exponent = 31 - __builtin_clz(value);
+    int sub = (value >> (exponent - 2)) & 3;
+    return 8 + (exponent - 3) * 4 + sub;
+}
+
+int Telemetry::Histogram::getBucketStart(int bucket) {
+    if (bucket < 8) {
+        return bucket;
+    }
+    int exponent = (bucket - 8) / 4 + 3;
+    int sub = (bucket - 8) % 4;
+    return (4 + sub) << (exponent - 2);
+}
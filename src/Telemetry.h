@@ -0,0 +1,81 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include <array>
+
+/* Per-frame simulation counters, for telling whether physics,
+ * interaction tests, rendering or audio makes a level slow. Counters
+ * are accumulated during a frame and closed off by |endFrame|. While
+ * enabled, every frame is kept for the CSV written at the end of the
+ * level, and fed into histograms for the on-screen percentiles.
+ * Main thread only. */
+class Telemetry
+{
+public:
+    enum Counter {
+        PARTICLES,
+        VOICES,
+        CONTACTS,
+        REPEL_TESTS,
+        ATTRACT_TESTS,
+        PHYSICS_MICROS,
+        DRAW_MICROS,
+        ALLOCATIONS,
+        COUNTER_COUNT
+    };
+    
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+    
+    /* Adds to or sets a counter for the current frame. */
+    static void add(Counter counter, int amount = 1);
+    static void set(Counter counter, int value);
+    
+    /* Closes the current frame and starts the next. */
+    static void endFrame();
+    
+    /* Writes the frames of the level that just ended as CSV to the
+     * given absolute path, logs their percentiles and starts over.
+     * Writes nothing while disabled. */
+    static void endLevel(const std::string path);
+    
+    /* Draws the current level's 50th, 95th and 99th percentiles with
+     * the top left corner at (x, y). */
+    static void drawHud(float x, float y);
+    
+    /* Height of the HUD in pixels. */
+    static float getHudHeight();
+    
+private:
+    /* Streaming histogram of non-negative values. Buckets are exact
+     * below 8 and then split each power of two into 4, so any
+     * percentile is within 25% of the true value and memory stays
+     * fixed no matter how many frames are added. */
+    class Histogram
+    {
+    public:
+        Histogram();
+        void add(int value);
+        void clear();
+        
+        /* Lower bound of the bucket holding the |fraction| quantile. */
+        int getPercentile(float fraction) const;
+        
+    private:
+        static const int BUCKETS = 128;
+        static int getBucket(int value);
+        static int getBucketStart(int bucket);
+        
+        int counts[BUCKETS];
+        int total;
+    };
+    
+    typedef std::array<int, COUNTER_COUNT> Frame;
+    
+    static bool enabled;
+    static Frame current;
+    static std::vector<Frame> frames;
+    static Histogram histograms[COUNTER_COUNT];
+    static uint64_t lastAllocationCount;
+};
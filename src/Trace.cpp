@@ -0,0 +1,141 @@
+#include "Trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+
+/* Zones kept per thread. Older zones are overwritten. */
+#define TRACE_BUFFER_EVENTS (1 << 16)
+
+/* Threads that can record at once: main, audio, the wave field
+ * workers and a few to spare. */
+#define TRACE_MAX_THREADS 16
+
+std::atomic<bool> Trace::enabled(false);
+Trace::ThreadBuffer* Trace::buffers = NULL;
+std::atomic<int> Trace::bufferCount(0);
+thread_local Trace::ThreadBuffer* Trace::threadBuffer = NULL;
+
+/* Guards allocating the buffers and writing them out. */
+static std::mutex buffersMutex;
+
+void Trace::setEnabled(bool enabled) {
+    if (enabled && bufferCount.load(std::memory_order_acquire) == 0) {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        buffers = new ThreadBuffer[TRACE_MAX_THREADS];
+        for (int i = 0; i < TRACE_MAX_THREADS; i++) {
+            buffers[i].id = i + 1;
+            buffers[i].claimed = false;
+            buffers[i].name = NULL;
+            buffers[i].head = 0;
+            buffers[i].events.resize(TRACE_BUFFER_EVENTS);
+        }
+        bufferCount.store(TRACE_MAX_THREADS, std::memory_order_release);
+    }
+    Trace::enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Trace::setThreadName(const char* name) {
+    // Threads claim a buffer once they record, so don't claim one yet.
+    if (!isEnabled()) {
+        return;
+    }
+    ThreadBuffer* buffer = getThreadBuffer();
+    if (buffer && buffer->name.load(std::memory_order_relaxed) != name) {
+        buffer->name.store(name, std::memory_order_relaxed);
+    }
+}
+
+void Trace::releaseThread() {
+    if (threadBuffer) {
+        threadBuffer->name.store(NULL, std::memory_order_relaxed);
+        threadBuffer->claimed.store(false, std::memory_order_release);
+        threadBuffer = NULL;
+    }
+}
+
+void Trace::record(const char* name, uint64_t start, uint64_t end) {
+    ThreadBuffer* buffer = getThreadBuffer();
+    if (!buffer) {
+        return;
+    }
+    uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    Event& event = buffer->events[head % TRACE_BUFFER_EVENTS];
+    event.name = name;
+    event.start = start;
+    event.end = end;
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+uint64_t Trace::now() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Trace::ThreadBuffer* Trace::getThreadBuffer() {
+    if (!threadBuffer) {
+        int count = bufferCount.load(std::memory_order_acquire);
+        for (int i = 0; i < count; i++) {
+            bool expected = false;
+            if (buffers[i].claimed.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                threadBuffer = &buffers[i];
+                break;
+            }
+        }
+    }
+    return threadBuffer;
+}
+
+bool Trace::write(const std::string path) {
+    std::ofstream out(path.c_str());
+    if (!out) {
+        std::cerr << "Could not write trace " << path << std::endl;
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    int count = bufferCount.load(std::memory_order_acquire);
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    for (int i = 0; i < count; i++) {
+        ThreadBuffer* buffer = &buffers[i];
+        
+        // Skip buffers no thread has recorded into.
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        if (head == 0) {
+            continue;
+        }
+        
+        // Copy the newest zones, then drop the ones the thread may have
+        // overwritten while they were being copied.
+        uint64_t begin = head > TRACE_BUFFER_EVENTS ? head - TRACE_BUFFER_EVENTS : 0;
+        std::vector<Event> events;
+        for (uint64_t j = begin; j < head; j++) {
+            events.push_back(buffer->events[j % TRACE_BUFFER_EVENTS]);
+        }
+        uint64_t after = buffer->head.load(std::memory_order_acquire);
+        uint64_t valid = after >= TRACE_BUFFER_EVENTS ? after - TRACE_BUFFER_EVENTS + 1 : 0;
+        
+        const char* name = buffer->name.load(std::memory_order_relaxed);
+        out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+            << buffer->id << ",\"args\":{\"name\":\"";
+        if (name) {
+            out << name;
+        }
+        else {
+            out << "thread " << buffer->id;
+        }
+        out << "\"}}";
+        first = false;
+        
+        for (uint64_t j = std::max(begin, valid); j < head; j++) {
+            const Event& event = events[j - begin];
+            out << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id
+                << ",\"ts\":" << event.start << ",\"dur\":" << (event.end - event.start) << "}";
+        }
+    }
+    out << "\n]}" << std::endl;
+    return true;
+}
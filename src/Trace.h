@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/* Scoped tracing zones, written out as Chrome trace JSON that can be
+ * opened in chrome://tracing or Perfetto. Mark a zone with
+ *
+ *     TRACE_SCOPE("Level::update");
+ *
+ * at the top of a block; it covers the rest of the block. Zone names
+ * must be string literals. Each thread records into its own ring
+ * buffer without locking, so the audio thread can be traced next to
+ * the game thread. The buffers are allocated when tracing is first
+ * turned on and threads claim one the first time they record, so
+ * recording never allocates or blocks; zones of threads beyond the
+ * preallocated buffers are dropped. While tracing is disabled a zone
+ * costs one relaxed atomic load, and building with TRACING=0
+ * compiles zones out. */
+#ifndef TRACING
+#define TRACING 1
+#endif
+
+#if TRACING
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_THREAD(name) Trace::setThreadName(name)
+#define TRACE_THREAD_END() Trace::releaseThread()
+#else
+#define TRACE_SCOPE(name)
+#define TRACE_THREAD(name)
+#define TRACE_THREAD_END()
+#endif
+
+class Trace
+{
+public:
+    /* Starts or stops recording zones. Allocates the thread buffers
+     * the first time it starts. */
+    static void setEnabled(bool enabled);
+    static bool isEnabled() {
+        return enabled.load(std::memory_order_relaxed);
+    }
+    
+    /* Names the calling thread in the trace. |name| must be a
+     * string literal. Does nothing while tracing is disabled, so
+     * call it from code that runs regularly on the thread. */
+    static void setThreadName(const char* name);
+    
+    /* Gives the calling thread's buffer back for another thread to
+     * claim. Call it when a thread that may have recorded exits, so
+     * short-lived threads don't use up the buffers. Its zones are
+     * kept until the buffer is reused. */
+    static void releaseThread();
+    
+    /* Records a finished zone on the calling thread. */
+    static void record(const char* name, uint64_t start, uint64_t end);
+    
+    /* Microseconds on a monotonic clock. */
+    static uint64_t now();
+    
+    /* Writes all recorded zones as Chrome trace JSON to the given
+     * absolute path. Safe to call while other threads record. Returns
+     * false if the file could not be written. */
+    static bool write(const std::string path);
+    
+private:
+    struct Event {
+        const char* name;
+        uint64_t start;
+        uint64_t end;
+    };
+    
+    /* Zones recorded by one thread. Only the thread that claimed it
+     * writes; readers copy events and then check |head| again to
+     * discard any that were overwritten while copying. */
+    struct ThreadBuffer {
+        int id;
+        std::atomic<bool> claimed;
+        std::atomic<const char*> name;
+        std::atomic<uint64_t> head;
+        std::vector<Event> events;
+    };
+    
+    /* The calling thread's buffer, claiming a free one the first
+     * time. NULL if the buffers aren't allocated or all are taken. */
+    static ThreadBuffer* getThreadBuffer();
+    
+    /* Buffers for all threads, and how many there are once
+     * allocated. Never freed, so zones of finished threads can still
+     * be written out. */
+    static ThreadBuffer* buffers;
+    static std::atomic<int> bufferCount;
+    
+    /* Buffer claimed by the calling thread. A plain pointer, so
+     * first use on the audio thread doesn't allocate. */
+    static thread_local ThreadBuffer* threadBuffer;
+    
+    static std::atomic<bool> enabled;
+};
+
+/* Records the lifetime of a block as a zone. Use |TRACE_SCOPE|. */
+class TraceScope
+{
+public:
+    TraceScope(const char* name)
+    : name(Trace::isEnabled() ? name : NULL), start(this->name ? Trace::now() : 0) {
+    }
+    
+    ~TraceScope() {
+        if (name) {
+            Trace::record(name, start, Trace::now());
+        }
+    }
+    
+private:
+    const char* name;
+    uint64_t start;
+};
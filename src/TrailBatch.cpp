@@ -0,0 +1,101 @@
+#include "TrailBatch.h"
+
+TrailBatch::TrailBatch() {
+}
+
+int TrailBatch::acquire() {
+    // Allocate all rings on first use, so levels without trails
+    // don't pay for them.
+    if (rings.empty()) {
+        rings.resize(MAX_TRAILS);
+        vertices.resize(MAX_TRAILS * TRAIL_LENGTH);
+        colors.resize(MAX_TRAILS * TRAIL_LENGTH);
+        indices.resize(MAX_TRAILS * (TRAIL_LENGTH - 1) * 2);
+        vbo.setVertexData(&vertices[0], vertices.size(), GL_STREAM_DRAW);
+        vbo.setColorData(&colors[0], colors.size(), GL_STREAM_DRAW);
+        vbo.setIndexData(&indices[0], indices.size(), GL_STREAM_DRAW);
+        indices.clear();
+        clear();
+    }
+    if (freeRings.empty()) {
+        return -1;
+    }
+    int trail = freeRings.top();
+    freeRings.pop();
+    rings[trail].used = true;
+    rings[trail].head = 0;
+    rings[trail].count = 0;
+    return trail;
+}
+
+void TrailBatch::release(int trail) {
+    if (trail < 0 || trail >= rings.size() || !rings[trail].used) {
+        return;
+    }
+    rings[trail].used = false;
+    freeRings.push(trail);
+}
+
+void TrailBatch::clear() {
+    freeRings = std::priority_queue<int, std::vector<int>, std::greater<int> >();
+    for (int i = 0; i < rings.size(); i++) {
+        rings[i].used = false;
+        freeRings.push(i);
+    }
+}
+
+void TrailBatch::add(int trail, const ofVec2f& position) {
+    if (trail < 0 || trail >= rings.size() || !rings[trail].used) {
+        return;
+    }
+    Ring& ring = rings[trail];
+    vertices[trail * TRAIL_LENGTH + ring.head] = ofVec3f(position.x, position.y, 0);
+    ring.head = (ring.head + 1) % TRAIL_LENGTH;
+    ring.count = min(ring.count + 1, TRAIL_LENGTH);
+}
+
+void TrailBatch::draw(const ofColor& color) {
+    if (size() == 0) {
+        return;
+    }
+    
+    // Connect each trail from its newest position back to its oldest,
+    // setting the fade by age since the ring moves every frame.
+    indices.clear();
+    ofFloatColor vertexColor(color);
+    float alpha = vertexColor.a;
+    int usedRings = 0;
+    for (int i = 0; i < rings.size(); i++) {
+        const Ring& ring = rings[i];
+        if (!ring.used) {
+            continue;
+        }
+        usedRings = i + 1;
+        if (ring.count < 2) {
+            continue;
+        }
+        int base = i * TRAIL_LENGTH;
+        for (int age = 0; age < ring.count; age++) {
+            int vertex = base + (ring.head - 1 - age + TRAIL_LENGTH) % TRAIL_LENGTH;
+            vertexColor.a = alpha * (1.f - (float)age / (TRAIL_LENGTH - 1));
+            colors[vertex] = vertexColor;
+            if (age > 0) {
+                indices.push_back(base + (ring.head - age + TRAIL_LENGTH) % TRAIL_LENGTH);
+                indices.push_back(vertex);
+            }
+        }
+    }
+    if (indices.empty()) {
+        return;
+    }
+    
+    // Upload only the rings in use, which are packed at the front.
+    vbo.updateVertexData(&vertices[0], usedRings * TRAIL_LENGTH);
+    vbo.updateColorData(&colors[0], usedRings * TRAIL_LENGTH);
+    vbo.updateIndexData(&indices[0], indices.size());
+    vbo.drawElements(GL_LINES, indices.size());
+}
+
+int TrailBatch::size() const {
+    return rings.size() - freeRings.size();
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include <functional>
+#include <queue>
+
+/* Positions kept per trail, and the most trails at once. */
+#define TRAIL_LENGTH 16
+#define MAX_TRAILS 4096
+
+/* Motion trails of many particles, drawn with a single draw call.
+ * Every trail owns a fixed ring of |TRAIL_LENGTH| vertices in one
+ * shared VBO, so adding a position overwrites the oldest one in
+ * place and memory stays the same no matter how long the game runs.
+ * Trails fade out from the newest position to the oldest. Free rings
+ * are reused lowest first, so live trails stay packed at the front
+ * and each frame only uploads the rings up to the last live one. The
+ * fixed-function renderer has no primitive restart, so trails are
+ * drawn as indexed line segments rather than strips. */
+class TrailBatch
+{
+public:
+    TrailBatch();
+    
+    /* Starts a trail. Returns its ID, or -1 if all trails are in use. */
+    int acquire();
+    
+    /* Ends a trail so its ring can be reused. */
+    void release(int trail);
+    
+    /* Ends all trails. */
+    void clear();
+    
+    /* Appends the newest position of a trail. */
+    void add(int trail, const ofVec2f& position);
+    
+    /* Draws all trails, fading |color| out along each one. */
+    void draw(const ofColor& color);
+    
+    /* Number of trails in use. */
+    int size() const;
+    
+private:
+    struct Ring {
+        bool used;
+        int head;
+        int count;
+    };
+    
+    std::vector<Ring> rings;
+    std::priority_queue<int, std::vector<int>, std::greater<int> > freeRings;
+    
+    /* Ring vertices, their colors and the segments of this frame, and
+     * the VBO they are uploaded to, allocated for all rings. */
+    std::vector<ofVec3f> vertices;
+    std::vector<ofFloatColor> colors;
+    std::vector<ofIndexType> indices;
+    ofVbo vbo;
+};
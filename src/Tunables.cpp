@@ -0,0 +1,169 @@
+#include "Tunables.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+/* Line height of the bitmap font used by the panel. */
+#define PANEL_LINE_HEIGHT 14
+
+const static std::string PRESET("preset");
+const static std::string DEFAULT_PRESET("default");
+
+/* Built-in defaults, in |Tunables::Tunable| order. */
+Tunables::Info Tunables::tunables[TUNABLE_COUNT] = {
+    // Name              Value     Step    Min      Max       Live
+    { "physics_fps",     90,       10,     10,      240,      true },
+    { "circle_error",    0.25f,    0.05f,  0.05f,   4,        true },
+    { "sample_rate",     44100,    0,      8000,    96000,    false },
+    { "audio_buffer",    1024,     0,      64,      8192,     false },
+    { "wave_range",      200,      10,     10,      1000,     true },
+    { "sink_wave_range", 100,      10,     10,      1000,     true },
+    { "wave_time_scale", 0.01f,    0.001f, 0,       0.1f,     true },
+    { "wave_pixel_scale", 10000,   1000,   1000,    100000,   true },
+    { "level_count",     6,        0,      1,       100,      false },
+    { "particle_radius", 10,       1,      2,       50,       true },
+    { "wave_field_cell", 4,        1,      1,       8,        true },
+};
+
+std::string Tunables::preset = DEFAULT_PRESET;
+unsigned int Tunables::revision = 0;
+bool Tunables::panelVisible = false;
+int Tunables::selected = 0;
+
+float Tunables::get(Tunable tunable) {
+    return tunables[tunable].value;
+}
+
+void Tunables::set(Tunable tunable, float value) {
+    Info& info = tunables[tunable];
+    info.value = ofClamp(value, info.min, info.max);
+    revision++;
+}
+
+bool Tunables::load(const std::string path, const std::string preset) {
+    std::ifstream in(path.c_str());
+    if (!in) {
+        ofLogWarning("Tunables") << "Could not open " << path << ", using built-in defaults";
+        return false;
+    }
+    
+    // Read the shared values and every preset, then apply the shared
+    // values followed by the chosen preset's.
+    std::map<std::string, std::vector<std::pair<int, float> > > sections;
+    std::string section;
+    std::string chosen = preset;
+    std::string line;
+    while (std::getline(in, line)) {
+        // Skip empty lines and comment lines.
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        if (line[0] == '[') {
+            section = line.substr(1, line.find(']') - 1);
+            sections[section];
+            continue;
+        }
+        
+        std::istringstream ss(line);
+        std::string name;
+        ss >> name;
+        if (name == PRESET) {
+            std::string named;
+            ss >> named;
+            if (chosen.empty()) {
+                chosen = named;
+            }
+            continue;
+        }
+        
+        float value;
+        if (!(ss >> value)) {
+            ofLogWarning("Tunables") << "Missing value for " << name << " in " << path;
+            continue;
+        }
+        int tunable = 0;
+        while (tunable < TUNABLE_COUNT && name != tunables[tunable].name) {
+            tunable++;
+        }
+        if (tunable == TUNABLE_COUNT) {
+            ofLogWarning("Tunables") << "Unknown tunable " << name << " in " << path;
+            continue;
+        }
+        const Info& info = tunables[tunable];
+        if (value < info.min || value > info.max) {
+            ofLogWarning("Tunables") << name << " " << value << " in " << path << " is outside "
+                                     << info.min << " to " << info.max << ", clamping";
+        }
+        sections[section].push_back(std::make_pair(tunable, value));
+    }
+    
+    if (chosen.empty()) {
+        chosen = DEFAULT_PRESET;
+    }
+    if (chosen != DEFAULT_PRESET && sections.find(chosen) == sections.end()) {
+        ofLogWarning("Tunables") << "Unknown preset " << chosen << " in " << path << ", using " << DEFAULT_PRESET;
+        chosen = DEFAULT_PRESET;
+    }
+    const std::string order[] = { "", chosen };
+    for (int i = 0; i < 2; i++) {
+        const std::vector<std::pair<int, float> >& values = sections[order[i]];
+        for (int j = 0; j < values.size(); j++) {
+            set((Tunable)values[j].first, values[j].second);
+        }
+    }
+    Tunables::preset = chosen;
+    ofLogNotice("Tunables") << "Loaded preset " << chosen << " from " << path;
+    return true;
+}
+
+std::string Tunables::getPreset() {
+    return preset;
+}
+
+unsigned int Tunables::getRevision() {
+    return revision;
+}
+
+void Tunables::setPanelVisible(bool visible) {
+    panelVisible = visible;
+}
+
+bool Tunables::isPanelVisible() {
+    return panelVisible;
+}
+
+void Tunables::select(int offset) {
+    // Step over tunables that need a restart.
+    int direction = offset < 0 ? -1 : 1;
+    for (int i = 0; i < abs(offset); i++) {
+        do {
+            selected = (selected + direction + TUNABLE_COUNT) % TUNABLE_COUNT;
+        } while (!tunables[selected].live);
+    }
+}
+
+void Tunables::adjust(int steps) {
+    if (!tunables[selected].live) {
+        select(1);
+    }
+    Info& info = tunables[selected];
+    set((Tunable)selected, info.value + steps * info.step);
+    ofLogNotice("Tunables") << info.name << " " << info.value;
+}
+
+void Tunables::drawPanel(float x, float y) {
+    ofPushStyle();
+    ofSetColor(255, 255, 255, 255);
+    std::ostringstream ss;
+    ss << "preset " << preset << " (arrows to tune)";
+    ofDrawBitmapString(ss.str(), x, y + PANEL_LINE_HEIGHT);
+    for (int i = 0; i < TUNABLE_COUNT; i++) {
+        const Info& info = tunables[i];
+        ss.str("");
+        ss << (i == selected ? "> " : "  ") << std::left << std::setw(18) << info.name
+           << info.value << (info.live ? "" : " (restart)");
+        ofDrawBitmapString(ss.str(), x, y + (i + 2) * PANEL_LINE_HEIGHT);
+    }
+    ofPopStyle();
+}
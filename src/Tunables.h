@@ -0,0 +1,75 @@
+#pragma once
+
+#include "ofMain.h"
+
+/* Performance knobs that can be tuned per machine without a rebuild.
+ * Values are loaded at startup from a config file with named presets,
+ * see bin/data/tunables.txt, and the ones marked live can also be
+ * changed while the game runs from an on-screen debug panel. Anything
+ * not in the file keeps its built-in default. Main thread only. */
+class Tunables
+{
+public:
+    enum Tunable {
+        PHYSICS_FPS,
+        CIRCLE_ERROR,
+        SAMPLE_RATE,
+        AUDIO_BUFFER_SIZE,
+        WAVE_RANGE,
+        SINK_WAVE_RANGE,
+        WAVE_TIME_SCALE,
+        WAVE_PIXEL_SCALE,
+        LEVEL_COUNT,
+        PARTICLE_RADIUS,
+        WAVE_FIELD_CELL,
+        TUNABLE_COUNT
+    };
+    
+    static float get(Tunable tunable);
+    
+    /* Sets a value, clamped to the tunable's range. */
+    static void set(Tunable tunable, float value);
+    
+    /* Loads values from the file at the given absolute path. Values
+     * at the top of the file apply to every preset, and the section
+     * of |preset| overrides them. If |preset| is empty, the preset
+     * named in the file is used. Returns false if the file could
+     * not be opened. */
+    static bool load(const std::string path, const std::string preset = "");
+    
+    /* Name of the loaded preset. */
+    static std::string getPreset();
+    
+    /* Changes whenever a value does, so caches built from values
+     * can tell when to rebuild. */
+    static unsigned int getRevision();
+    
+    /* Debug panel listing all values. Only live tunables can be
+     * selected and adjusted; the others take effect on restart. */
+    static void setPanelVisible(bool visible);
+    static bool isPanelVisible();
+    
+    /* Moves the selection by |offset| live tunables. */
+    static void select(int offset);
+    
+    /* Changes the selected value by |steps| steps. */
+    static void adjust(int steps);
+    
+    /* Draws the panel with the top left corner at (x, y). */
+    static void drawPanel(float x, float y);
+    
+private:
+    struct Info {
+        const char* name;
+        float value;
+        float step;
+        float min, max;
+        bool live;
+    };
+    
+    static Info tunables[TUNABLE_COUNT];
+    static std::string preset;
+    static unsigned int revision;
+    static bool panelVisible;
+    static int selected;
+};
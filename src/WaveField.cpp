@@ -0,0 +1,308 @@
+#include "WaveField.h"
+#include "GameClock.h"
+#include "Trace.h"
+#include "Tunables.h"
+
+#include <math.h>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define WAVE_FIELD_SSE 1
+#endif
+
+/* Wave speed in pixels per second of game time. */
+#define WAVE_SPEED 240.f
+
+/* Squared wave speed in cells per step. The stencil is only stable
+ * up to 0.5, so smaller cells take more steps per second. */
+#define WAVE_SPEED_SQUARED 0.25f
+
+/* Most game time one update catches up on. Longer frames skip ahead. */
+#define MAX_CATCH_UP (1.f / 15)
+
+/* Fraction of the displacement kept per second, so waves fade out
+ * as they spread instead of filling the window. */
+#define DAMPING_PER_SECOND 0.4f
+
+/* Displacement of a cell at full opacity. */
+#define FULL_DISPLACEMENT 0.15f
+
+/* Displacement of the center cell of a full strength impulse. */
+#define IMPULSE_DISPLACEMENT 2.f
+
+/* Worker threads besides the calling thread. */
+#define MAX_WORKERS 7
+
+WaveField::WaveField() {
+}
+
+WaveField::~WaveField() {
+    stopWorkers();
+}
+
+void WaveField::setEnabled(bool enabled) {
+    if (enabled == this->enabled) {
+        return;
+    }
+    this->enabled = enabled;
+    if (enabled) {
+        startWorkers();
+        clear();
+    }
+    else {
+        stopWorkers();
+    }
+}
+
+bool WaveField::isEnabled() const {
+    return enabled;
+}
+
+void WaveField::addEmitter(const ofVec2f& position, float frequency, float amplitude) {
+    Emitter emitter = { position, frequency, amplitude };
+    emitters.push_back(emitter);
+}
+
+void WaveField::addImpulse(const ofVec2f& position, float strength) {
+    Emitter impulse = { position, 0, strength };
+    impulses.push_back(impulse);
+}
+
+void WaveField::update(int width, int height) {
+    TRACE_SCOPE("WaveField::update");
+    if (!enabled) {
+        emitters.clear();
+        impulses.clear();
+        return;
+    }
+    allocate(width, height);
+    
+    // Strikes displace a small blob of cells once.
+    for (int i = 0; i < impulses.size(); i++) {
+        // Keep the blob off the border, which must stay still.
+        int cell = getCell(impulses[i].position);
+        int x = cell % columns, y = cell / columns;
+        if (cell == -1 || x < 2 || x >= columns - 2 || y < 2 || y >= rows - 2) {
+            continue;
+        }
+        float displacement = impulses[i].amplitude * IMPULSE_DISPLACEMENT;
+        current[cell] += displacement;
+        current[cell - 1] += displacement / 2;
+        current[cell + 1] += displacement / 2;
+        current[cell - columns] += displacement / 2;
+        current[cell + columns] += displacement / 2;
+    }
+    
+    // Step at a fixed rate of game time, so the waves look the same
+    // at any frame rate and replays match.
+    double now = GameClock::getTime();
+    if (time < 0 || now < time) {
+        time = now;
+    }
+    if (now - time > MAX_CATCH_UP) {
+        time = now - MAX_CATCH_UP;
+    }
+    int steps = (now - time) / stepTime;
+    
+    float timeScale = Tunables::get(Tunables::WAVE_TIME_SCALE);
+    for (int i = 0; i < steps; i++) {
+        // Emitters hold the cell under them at their signal, like
+        // the rim of a speaker. Ring frequencies are scaled down to
+        // what the grid can show, as for |WaveRings|.
+        time += stepTime;
+        for (int j = 0; j < emitters.size(); j++) {
+            int cell = getCell(emitters[j].position);
+            if (cell != -1) {
+                float phase = fmod(emitters[j].frequency * timeScale * time, 1.0);
+                current[cell] = emitters[j].amplitude * sin(TWO_PI * phase);
+            }
+        }
+        run(STEP);
+        std::swap(current, previous);
+    }
+    
+    if (steps > 0 || impulses.size() > 0 || !uploaded) {
+        run(COLOR);
+        texture.loadData(pixels.getPixels(), columns - 2, rows - 2, GL_RGBA);
+        uploaded = true;
+    }
+    emitters.clear();
+    impulses.clear();
+}
+
+void WaveField::draw() {
+    if (!enabled || !uploaded) {
+        return;
+    }
+    ofPushStyle();
+    ofEnableAlphaBlending();
+    ofSetColor(255, 255, 255, 255);
+    texture.draw(0, 0, (columns - 2) * cellSize, (rows - 2) * cellSize);
+    ofPopStyle();
+}
+
+void WaveField::clear() {
+    std::fill(current.begin(), current.end(), 0.f);
+    std::fill(previous.begin(), previous.end(), 0.f);
+    emitters.clear();
+    impulses.clear();
+    time = -1;
+    uploaded = false;
+}
+
+void WaveField::allocate(int width, int height) {
+    int cellSize = max((int)Tunables::get(Tunables::WAVE_FIELD_CELL), 1);
+    if (width == this->width && height == this->height && cellSize == this->cellSize) {
+        return;
+    }
+    this->width = width;
+    this->height = height;
+    this->cellSize = cellSize;
+    
+    // Keep the wave speed in pixels the same at any cell size.
+    stepTime = cellSize * sqrt(WAVE_SPEED_SQUARED) / WAVE_SPEED;
+    damping = pow(DAMPING_PER_SECOND, stepTime);
+    
+    // One cell per |cellSize| pixels, rounded up, plus the border.
+    columns = (width + cellSize - 1) / cellSize + 2;
+    rows = (height + cellSize - 1) / cellSize + 2;
+    current.assign(columns * rows, 0.f);
+    previous.assign(columns * rows, 0.f);
+    pixels.allocate(columns - 2, rows - 2, OF_IMAGE_COLOR_ALPHA);
+    texture.allocate(columns - 2, rows - 2, GL_RGBA);
+    texture.setTextureMinMagFilter(GL_LINEAR, GL_LINEAR);
+    uploaded = false;
+}
+
+int WaveField::getCell(const ofVec2f& position) const {
+    int x = floor(position.x / cellSize) + 1;
+    int y = floor(position.y / cellSize) + 1;
+    if (x < 1 || x >= columns - 1 || y < 1 || y >= rows - 1) {
+        return -1;
+    }
+    return y * columns + x;
+}
+
+void WaveField::run(Phase phase) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->phase = phase;
+        pending = workers.size();
+        generation++;
+    }
+    started.notify_all();
+    runBand(phase, 0);
+    
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this] { return pending == 0; });
+}
+
+void WaveField::runBand(Phase phase, int band) {
+    // Split the rows inside the border evenly.
+    int bands = workers.size() + 1;
+    int first = 1 + (rows - 2) * band / bands;
+    int last = 1 + (rows - 2) * (band + 1) / bands;
+    if (phase == STEP) {
+        step(first, last);
+    }
+    else {
+        color(first, last);
+    }
+}
+
+void WaveField::step(int first, int last) {
+    TRACE_SCOPE("WaveField::step");
+    
+    // next = damping * (2 * current - previous + speed^2 * laplacian),
+    // written over |previous|, which is only read at the same cell.
+    for (int y = first; y < last; y++) {
+        const float* up = &current[(y - 1) * columns];
+        const float* row = &current[y * columns];
+        const float* down = &current[(y + 1) * columns];
+        float* out = &previous[y * columns];
+        int x = 1;
+#ifdef WAVE_FIELD_SSE
+        const __m128 speed = _mm_set1_ps(WAVE_SPEED_SQUARED);
+        const __m128 keep = _mm_set1_ps(damping);
+        const __m128 four = _mm_set1_ps(4.f);
+        for (; x + 4 <= columns - 1; x += 4) {
+            __m128 center = _mm_loadu_ps(row + x);
+            __m128 neighbors = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(row + x - 1), _mm_loadu_ps(row + x + 1)),
+                                          _mm_add_ps(_mm_loadu_ps(up + x), _mm_loadu_ps(down + x)));
+            __m128 laplacian = _mm_sub_ps(neighbors, _mm_mul_ps(four, center));
+            __m128 next = _mm_sub_ps(_mm_add_ps(_mm_add_ps(center, center), _mm_mul_ps(speed, laplacian)),
+                                     _mm_loadu_ps(out + x));
+            _mm_storeu_ps(out + x, _mm_mul_ps(keep, next));
+        }
+#endif
+        for (; x < columns - 1; x++) {
+            float laplacian = row[x - 1] + row[x + 1] + up[x] + down[x] - 4.f * row[x];
+            out[x] = damping * (2.f * row[x] - out[x] + WAVE_SPEED_SQUARED * laplacian);
+        }
+    }
+}
+
+void WaveField::color(int first, int last) {
+    TRACE_SCOPE("WaveField::color");
+    
+    // Crests are white and troughs blue, more opaque the further
+    // the cell is displaced.
+    unsigned char* data = pixels.getPixels();
+    for (int y = first; y < last; y++) {
+        const float* row = &current[y * columns];
+        unsigned char* pixel = data + (y - 1) * (columns - 2) * 4;
+        for (int x = 1; x < columns - 1; x++, pixel += 4) {
+            float displacement = row[x] / FULL_DISPLACEMENT;
+            bool crest = displacement > 0;
+            pixel[0] = crest ? 255 : 64;
+            pixel[1] = crest ? 255 : 128;
+            pixel[2] = 255;
+            pixel[3] = min(fabs(displacement), 1.f) * 255;
+        }
+    }
+}
+
+void WaveField::startWorkers() {
+    stopWorkers();
+    int count = min(max((int)std::thread::hardware_concurrency() - 1, 0), MAX_WORKERS);
+    for (int i = 0; i < count; i++) {
+        workers.push_back(std::thread(&WaveField::work, this, i + 1, generation));
+    }
+}
+
+void WaveField::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    started.notify_all();
+    for (int i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+    workers.clear();
+    stopping = false;
+}
+
+void WaveField::work(int band, unsigned int seen) {
+    TRACE_THREAD("wave field");
+    while (true) {
+        Phase phase;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            started.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) {
+                TRACE_THREAD_END();
+                return;
+            }
+            seen = generation;
+            phase = this->phase;
+        }
+        runBand(phase, band);
+        
+        std::lock_guard<std::mutex> lock(mutex);
+        pending--;
+        if (pending == 0) {
+            finished.notify_one();
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/* Optional simulation of the sound waves on a 2D grid, as an
+ * alternative to |WaveRings|. Sounding objects drive the grid cells
+ * under them, and the waves spread, reflect and interfere following
+ * the wave equation. The grid is coarser than the window, see the
+ * |Tunables::WAVE_FIELD_CELL| size, and is stepped at a fixed rate
+ * of game time. Each step is a 5-point stencil over the grid,
+ * vectorized with SSE and split into bands of rows that run on a pool
+ * of worker threads and the calling thread. The result is colored on
+ * the workers too and uploaded as one texture per frame. */
+class WaveField
+{
+public:
+    WaveField();
+    ~WaveField();
+    
+    /* Starts the worker threads and clears the field, or stops them. */
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+    
+    /* Drives the field at |position| with a sine of the given
+     * frequency until the next |update|. |amplitude| is from 0 to 1,
+     * like a mixer volume. */
+    void addEmitter(const ofVec2f& position, float frequency, float amplitude);
+    
+    /* Displaces the field at |position| once, like a strike.
+     * |strength| is from 0 to 1. */
+    void addImpulse(const ofVec2f& position, float strength);
+    
+    /* Advances the field to the current game time for a window of the
+     * given size, then removes all emitters. Positions are in window
+     * pixels. */
+    void update(int width, int height);
+    
+    /* Draws the field stretched over the window. */
+    void draw();
+    
+    /* Flattens the field. */
+    void clear();
+
+private:
+    /* A sine driving the cell under |position| during |update|, or
+     * for impulses a one-off displacement of |amplitude|. */
+    struct Emitter {
+        ofVec2f position;
+        float frequency, amplitude;
+    };
+    
+    /* Work the threads do on each band of rows. */
+    enum Phase {
+        STEP,
+        COLOR
+    };
+    
+    /* Sizes the grid for the window and current cell size. The field
+     * is flattened if the size changes. */
+    void allocate(int width, int height);
+    
+    /* Index of the cell under |position|, or -1 if it is off the
+     * grid or on its border. */
+    int getCell(const ofVec2f& position) const;
+    
+    /* Runs |phase| on all bands and waits for it to finish. */
+    void run(Phase phase);
+    
+    /* Runs |phase| on one band of rows, and its parts on rows
+     * [|first|, |last|). */
+    void runBand(Phase phase, int band);
+    void step(int first, int last);
+    void color(int first, int last);
+    
+    void startWorkers();
+    void stopWorkers();
+    
+    /* Worker loop. |seen| is the generation at start, so phases
+     * started before the thread first runs aren't missed. */
+    void work(int band, unsigned int seen);
+    
+    bool enabled = false;
+    
+    /* Grid size in cells, including a border of still cells, the
+     * window size it was made for, and the cell size in pixels. */
+    int columns = 0, rows = 0;
+    int width = 0, height = 0;
+    int cellSize = 0;
+    
+    /* Game time per step, and the fraction of the displacement each
+     * step keeps, for the current cell size. */
+    double stepTime = 0;
+    float damping = 1;
+    
+    /* Displacement now and one step ago. Each step writes the next
+     * displacement over the previous one, then the two swap. */
+    std::vector<float> current;
+    std::vector<float> previous;
+    
+    /* Game time the field has been stepped to. */
+    double time = -1;
+    
+    /* Added since the last |update|. */
+    std::vector<Emitter> emitters;
+    std::vector<Emitter> impulses;
+    
+    ofPixels pixels;
+    ofTexture texture;
+    bool uploaded = false;
+    
+    /* Worker pool. Each worker runs one band of every phase; the
+     * calling thread runs band 0. Shared with the workers and guarded
+     * by |mutex|: |phase|, |generation|, |pending| and |stopping|. */
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable started;
+    std::condition_variable finished;
+    Phase phase = STEP;
+    unsigned int generation = 0;
+    int pending = 0;
+    bool stopping = false;
+};
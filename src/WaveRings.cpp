@@ -0,0 +1,89 @@
+#include "WaveRings.h"
+#include "CircleTessellation.h"
+#include "GameClock.h"
+
+std::map<WaveRings::Key, std::vector<ofVboMesh> > WaveRings::cache;
+unsigned int WaveRings::cacheRevision = 0;
+bool WaveRings::enabled = true;
+
+bool WaveRings::Key::operator<(const Key& other) const {
+    if (baseRadius != other.baseRadius) return baseRadius < other.baseRadius;
+    if (frequency != other.frequency) return frequency < other.frequency;
+    if (range != other.range) return range < other.range;
+    return color < other.color;
+}
+
+void WaveRings::draw(const ofVec2f& center, float baseRadius, float frequency,
+                     float range, const ofColor& color) {
+    if (!enabled) {
+        return;
+    }
+    
+    // Ring spacing and tessellation are tunable, so rebuild after
+    // they change.
+    if (cacheRevision != Tunables::getRevision()) {
+        cache.clear();
+        cacheRevision = Tunables::getRevision();
+    }
+    
+    Key key = { baseRadius, frequency, range, (unsigned int)color.getHex() << 8 | color.a };
+    std::vector<ofVboMesh>& phases = cache[key];
+    if (phases.empty()) {
+        phases.resize(PHASES);
+        float period = 1.f / frequency;
+        for (int i = 0; i < PHASES; i++) {
+            build(key, period * i / PHASES, color, phases[i]);
+        }
+    }
+    
+    // Pick the prebuilt phase closest to the current offset.
+    float period = 1.f / frequency;
+    float offset = fmod(Tunables::get(Tunables::WAVE_TIME_SCALE) * GameClock::getTime(), period);
+    int phase = (int)(offset / period * PHASES) % PHASES;
+    
+    ofPushMatrix();
+    ofTranslate(center.x, center.y, 0);
+    ofPushStyle();
+    ofSetLineWidth(3);
+    phases[phase].draw();
+    ofPopStyle();
+    ofPopMatrix();
+}
+
+void WaveRings::setEnabled(bool enabled) {
+    WaveRings::enabled = enabled;
+}
+
+void WaveRings::build(const Key& key, float offset, const ofColor& color, ofVboMesh& mesh) {
+    mesh.setMode(OF_PRIMITIVE_LINES);
+    mesh.setUsage(GL_STATIC_DRAW);
+    
+    float period = 1.f / key.frequency;
+    float pixelScale = Tunables::get(Tunables::WAVE_PIXEL_SCALE);
+    float alpha = 1.f;
+    std::vector<float> radii;
+    std::vector<float> alphas;
+    for (float x = offset; x * pixelScale < key.range; x += period) {
+        alpha = (key.range - x * pixelScale) / key.range;
+        radii.push_back(key.baseRadius + x * pixelScale);
+        alphas.push_back(alpha);
+    }
+    
+    // The rim of the object itself, in the color of the last ring.
+    radii.push_back(key.baseRadius);
+    alphas.push_back(alpha);
+    
+    for (int i = 0; i < radii.size(); i++) {
+        ofFloatColor ringColor(color);
+        ringColor.a *= alphas[i];
+        int resolution = CircleTessellation::getSegments(radii[i]);
+        const std::vector<ofVec2f>& unitCircle = CircleTessellation::getUnitCircle(resolution);
+        ofIndexType base = mesh.getNumVertices();
+        for (int j = 0; j < resolution; j++) {
+            mesh.addVertex(ofVec3f(unitCircle[j].x * radii[i], unitCircle[j].y * radii[i], 0));
+            mesh.addColor(ringColor);
+            mesh.addIndex(base + j);
+            mesh.addIndex(base + (j + 1) % resolution);
+        }
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "ofMain.h"
+#include "Tunables.h"
+
+/* Draws the concentric wave rings around sound sources and sinks.
+ * Ring geometry only depends on the frequency, so for each kind
+ * of ring set the animation is prebuilt as a small number of
+ * meshes, one per phase, with the alpha ramp baked into the vertex
+ * colors. Each frame just picks the mesh for the current phase, so
+ * drawing costs one call no matter how many rings there are. */
+class WaveRings
+{
+public:
+    /* Draws rings of the given frequency around |center|, starting
+     * at |baseRadius| and fading out over |range| pixels. */
+    static void draw(const ofVec2f& center, float baseRadius, float frequency,
+                     float range, const ofColor& color);
+    
+    /* While disabled, |draw| draws nothing, so a |WaveField| can
+     * show the waves instead. */
+    static void setEnabled(bool enabled);
+    
+private:
+    /* Number of prebuilt animation phases per ring set. */
+    static const int PHASES = 32;
+    
+    struct Key {
+        float baseRadius, frequency, range;
+        unsigned int color;
+        bool operator<(const Key& other) const;
+    };
+    
+    /* Builds the ring set for one phase of the animation. */
+    static void build(const Key& key, float offset, const ofColor& color, ofVboMesh& mesh);
+    
+    static bool enabled;
+    
+    static std::map<Key, std::vector<ofVboMesh> > cache;
+    
+    /* |Tunables| revision the cache was built with. */
+    static unsigned int cacheRevision;
+};
@@ -1,8 +1,39 @@
 #include "ofMain.h"
 #include "ofApp.h"
 
-int main() {
+/* Usage:
+ *   soundSurfer                               play
+ *   soundSurfer --record <session>            play and record the session
+ *   soundSurfer --export <session> <directory>
+ *                                             save a recorded session as PNG frames
+ *   soundSurfer --bench <results>             run the benchmarks and save the results
+ *   soundSurfer --sweep <results>             run the scaling sweep and save the results
+ *
+ * Any of these can be followed by --preset <name> to pick a preset
+ * from bin/data/tunables.txt. */
+int main(int argc, char* argv[]) {
+    ofApp* app = new ofApp(1024, 768);
+    std::string option = argc > 1 ? argv[1] : "";
+    if (option == "--record" && argc > 2) {
+        app->recordSession(ofFilePath::getAbsolutePath(argv[2], false));
+    }
+    else if (option == "--bench" && argc > 2) {
+        app->runBenchmarks(ofFilePath::getAbsolutePath(argv[2], false));
+    }
+    else if (option == "--sweep" && argc > 2) {
+        app->runSweep(ofFilePath::getAbsolutePath(argv[2], false));
+    }
+    else if (option == "--export" && argc > 3) {
+        app->exportSession(ofFilePath::getAbsolutePath(argv[2], false),
+                           ofFilePath::getAbsolutePath(argv[3], false));
+    }
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::string(argv[i]) == "--preset") {
+            app->usePreset(argv[i + 1]);
+        }
+    }
+    
     //ofSetCurrentRenderer(ofGLProgrammableRenderer::TYPE);
 	ofSetupOpenGL(1024,768,OF_WINDOW);
-	ofRunApp(new ofApp(1024, 768));
+	ofRunApp(app);
 }
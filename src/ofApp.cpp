@@ -1,117 +1,555 @@
 #include "ofApp.h"
+#include "Trace.h"
+#include "Telemetry.h"
+#include "Allocations.h"
+#include "Tunables.h"
+#include "WaveRings.h"
 
-#define LEVEL_COUNT 6
+#include <iomanip>
+#include <thread>
+
+/* Width of the tunables panel, in pixels. */
+#define TUNABLES_PANEL_WIDTH 320
+
+/* Frames each look is drawn for while timing bloom. */
+#define TIMING_FRAMES 120
+
+/* Seconds without motion or input before the app idles, and the
+ * frame rate while idle. */
+#define IDLE_DELAY 2.f
+#define IDLE_FRAME_RATE 10
 
 ofApp::ofApp(float width, float height)
-: windowWidth(width), windowHeight(height) {
+: windowWidth(width), windowHeight(height), levelGenerator(time(NULL)), levelPrefetcher(levelGenerator) {
 }
 
 ofApp::~ofApp() {
+    if (Trace::isEnabled()) {
+        writeTrace();
+    }
+    levelPrefetcher.waitForThread(true);
+    frameEncoder.finish();
 }
 
 //--------------------------------------------------------------
 void ofApp::setup() {
+    // Load tunables first, since benchmarks use them too.
+    Tunables::load(ofToDataPath("tunables.txt", true), preset);
+    
+    // Benchmarks set up worlds of their own, so run them before
+    // the app's own setup.
+    if (!benchmarkPath.empty()) {
+        Benchmarks::run(benchmarkPath);
+        ofExit();
+    }
+    if (!sweepPath.empty()) {
+        Benchmarks::sweep(sweepPath);
+        ofExit();
+    }
+    
     // Init box2d.
     box2d.init();
     box2d.setGravity(0, 10);
-    box2d.setFPS(90.0);
+    box2d.setFPS(Tunables::get(Tunables::PHYSICS_FPS));
     box2d.enableEvents();
+    ofAddListener(box2d.contactStartEvents, this, &ofApp::onContactStart);
     
     // OpenFramework variables.
-    ofSetCircleResolution(50);
     ofSetLineWidth(2.f);
     
     // Init audio system for particles.
-    sm = shared_ptr<ofSoundMixer>(new ofSoundMixer(this, 0));
+    sm = shared_ptr<ofSoundMixer>(new ofSoundMixer(this, 0, Tunables::get(Tunables::SAMPLE_RATE),
+                                                   Tunables::get(Tunables::AUDIO_BUFFER_SIZE)));
+    if (sm->LoadSampleBank(ofToDataPath("samples.bank", true))) {
+        ofLogNotice("ofSoundMixer") << "Loaded sample bank";
+    }
     SoundSource::Initialize(sm.get());
     SoundParticle::Initialize(sm.get());
     ParticleSink::Initialize(sm.get());
     
-    // Load levels.
-    Level::Initialize(&box2d, sm.get());
-    currentLevelIndex = 0;
-    currentLevel = new Level("level1.txt");
-    
     // Load instruction image.
-    instructions.loadImage("instructions.png");
-    help.loadImage("help.png");
+    instructions = AssetCache::getImage("instructions.png");
+    help = AssetCache::getImage("help.png");
+    
+    // Load shared font before the first level, so levels reuse it.
+    font = AssetCache::getFont("Kiddish.ttf", 40);
     
-    // Load shared font if it hasn't been loaded.
-    if (!font.isLoaded()) {
-        font.loadFont("Kiddish.ttf", 40, true, true);
+    // Replay a recorded session, or record this one. Generated
+    // levels must match, so the seed is set before any are made.
+    if (isExporting()) {
+        if (!session.loadFromFile(exportPath) || !ofDirectory::createDirectory(exportDirectory, false, true)) {
+            ofLogError("Export") << "Could not export " << exportPath << " to " << exportDirectory;
+            session.frames.clear();
+        }
+        levelGenerator.setSeed(session.seed);
+        if (session.width > 0 && session.height > 0) {
+            setWindowSize(session.width, session.height);
+        }
+        frameEncoder.start(std::max((int)std::thread::hardware_concurrency() - 1, 1));
+        sm->SetMuted(true);
+        ofSetVerticalSync(false);
+        ofSetFrameRate(0);
     }
+    else if (!recordPath.empty()) {
+        recorder.open(recordPath, levelGenerator.getSeed(), windowWidth, windowHeight);
+    }
+    
+    TRACE_THREAD("main");
+    
+    // Load levels.
+    Level::Initialize(&box2d, sm.get());
+    Level::setWindowSize(windowWidth, windowHeight);
+    if (levelPack.open(ofToDataPath("levels.pack", true))) {
+        levelCount = levelPack.getLevelCount();
+    }
+    else {
+        levelCount = Tunables::get(Tunables::LEVEL_COUNT);
+    }
+    currentLevelIndex = 0;
+    currentLevel = loadLevel(currentLevelIndex);
+    levelPrefetcher.startThread(true, false);
+    prefetchNextLevel();
 }
 
 //--------------------------------------------------------------
 void ofApp::update() {
-    box2d.update();
+    // Advance the game clock, from the session when exporting. Input
+    // that arrived after the previous frame is replayed first, just
+    // as it was received during the session.
+    if (isExporting()) {
+        if (exportFrame > 0 && exportFrame <= session.frames.size()) {
+            replayInput(session.frames[exportFrame - 1]);
+        }
+        if (exportFrame >= session.frames.size()) {
+            finishExport();
+            return;
+        }
+        GameClock::setTime(session.frames[exportFrame].time);
+    }
+    else {
+        waitWhileIdle();
+        GameClock::update();
+        recorder.frame(GameClock::getTime());
+    }
+    
+    TRACE_SCOPE("ofApp::update");
+    {
+        TRACE_SCOPE("ofxBox2d::update");
+        box2d.setFPS(Tunables::get(Tunables::PHYSICS_FPS));
+        unsigned long long start = ofGetElapsedTimeMicros();
+        box2d.update();
+        Telemetry::set(Telemetry::PHYSICS_MICROS, ofGetElapsedTimeMicros() - start);
+    }
+    sm->Update();
+    Telemetry::set(Telemetry::VOICES, sm->GetActiveSourceCount());
     if (currentLevel->complete()) {
+        endLevelTelemetry();
         score += currentLevel->getLineCount();
         delete currentLevel;
         currentLevel = loadNextLevel();
     }
+    
+    // Apply edits to the level file to the running level.
+    if (levelWatcher.hasChanged()) {
+        LevelDescription updated;
+        if (updated.loadFromFile(levelWatcher.getPath())) {
+            currentLevel->applyChanges(watchedLevel, updated);
+            std::swap(watchedLevel, updated);
+        }
+    }
     currentLevel->update();
+    waveField.update(windowWidth, windowHeight);
+    updateIdle();
+}
+
+//--------------------------------------------------------------
+void ofApp::updateIdle() {
+    float now = ofGetElapsedTimef();
+    if (isExporting() || !isWorldAsleep()) {
+        lastActiveTime = now;
+    }
+    idle = now - lastActiveTime > IDLE_DELAY;
+}
+
+//--------------------------------------------------------------
+void ofApp::waitWhileIdle() {
+    float now = ofGetElapsedTimef();
+    if (idle) {
+        // Sleep out the rest of an idle frame, but no later than the
+        // next emission, so particles are emitted on time.
+        float wakeTime = min(lastUpdateTime + 1.f / IDLE_FRAME_RATE, currentLevel->getNextEmissionTime());
+        if (wakeTime > now) {
+            TRACE_SCOPE("ofApp::idle");
+            ofSleepMillis(ceil((wakeTime - now) * 1000));
+            now = ofGetElapsedTimef();
+        }
+    }
+    lastUpdateTime = now;
+}
+
+//--------------------------------------------------------------
+bool ofApp::isWorldAsleep() {
+    for (b2Body* body = box2d.getWorld()->GetBodyList(); body; body = body->GetNext()) {
+        if (body->GetType() == b2_dynamicBody && body->IsAwake()) {
+            return false;
+        }
+    }
+    return true;
 }
 
 //--------------------------------------------------------------
 Level* ofApp::loadNextLevel() {
-    currentLevelIndex++;
-    if (currentLevelIndex >= LEVEL_COUNT) {
-        currentLevelIndex = 0;
+    TRACE_SCOPE("ofApp::loadNextLevel");
+    currentLevelIndex = getNextLevelIndex();
+    
+    // Use the prefetched level if it is ready, so only the bodies
+    // and voices have to be created here.
+    Level* level;
+    LevelDescription description;
+    if (levelPrefetcher.take(currentLevelIndex, description)) {
+        level = new Level(description);
+    }
+    else if (currentLevelIndex < levelCount) {
+        level = loadLevel(currentLevelIndex);
+    }
+    else {
+        levelGenerator.generate(currentLevelIndex + 1, description);
+        level = new Level(description);
+    }
+    prefetchNextLevel();
+    watchLevel(currentLevelIndex);
+    return level;
+}
+
+//--------------------------------------------------------------
+Level* ofApp::loadLevel(int index) {
+    if (levelPack.isOpen()) {
+        return new Level(levelPack, index);
     }
+    return new Level(getLevelFilename(index));
+}
+
+//--------------------------------------------------------------
+std::string ofApp::getLevelFilename(int index) {
     std::ostringstream ss;
-    ss << "level" << (currentLevelIndex + 1) << ".txt";
-    std::string filename = ss.str();
-    return new Level(filename);
+    ss << "level" << (index + 1) << ".txt";
+    return ss.str();
+}
+
+//--------------------------------------------------------------
+int ofApp::getNextLevelIndex() {
+    int index = currentLevelIndex + 1;
+    if (index >= levelCount && !endlessMode) {
+        index = 0;
+    }
+    return index;
+}
+
+//--------------------------------------------------------------
+void ofApp::prefetchNextLevel() {
+    // Levels in the pack are read in place and need no prefetching.
+    int index = getNextLevelIndex();
+    if (index >= levelCount) {
+        levelPrefetcher.requestGenerated(index);
+    }
+    else if (!levelPack.isOpen()) {
+        levelPrefetcher.requestFile(index, ofToDataPath(getLevelFilename(index), true));
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::watchLevel(int index) {
+    levelWatcher.stop();
+    watchedLevel.clear();
+    
+    // Generated levels have no file to watch.
+    if (!liveReload || index >= levelCount) {
+        return;
+    }
+    
+    // Remember what the file looks like now, so later edits can
+    // be diffed against it.
+    std::string path = ofToDataPath(getLevelFilename(index), true);
+    if (watchedLevel.loadFromFile(path)) {
+        levelWatcher.watch(path);
+    }
 }
 
 //--------------------------------------------------------------
 void ofApp::draw() {
+    TRACE_SCOPE("ofApp::draw");
+    unsigned long long drawStart = ofGetElapsedTimeMicros();
+    
     // Hack to fix mouse disappearance bug.
     ofHideCursor();
     ofShowCursor();
     
-    // Draw game level.
+    // Exported frames are drawn off-screen at the session's window
+    // size, so they don't depend on the actual window.
+    bool capturing = isExporting() && exportFrame < session.frames.size();
+    if (capturing) {
+        if (!exportFbo.isAllocated() || exportFbo.getWidth() != (int)windowWidth ||
+            exportFbo.getHeight() != (int)windowHeight) {
+            exportFbo.allocate(windowWidth, windowHeight, GL_RGB);
+        }
+        exportFbo.begin();
+    }
+    
+    // Draw game level, with the static layer composited on top.
     ofBackground(0, 0, 0);
-    currentLevel->draw();
+    unsigned long long start = 0;
+    if (bloomTiming) {
+        glFinish();
+        start = ofGetElapsedTimeMicros();
+    }
+    if (bloom.isEnabled()) {
+        bloom.begin(windowWidth, windowHeight);
+    }
+    waveField.draw();
+    currentLevel->drawWaves();
+    currentLevel->drawObjects();
+    if (bloom.isEnabled()) {
+        TRACE_SCOPE("Bloom::end");
+        bloom.end();
+    }
+    if (bloomTiming) {
+        // The first frame of a look may allocate buffers, so skip it.
+        glFinish();
+        if (timedFrames > 0) {
+            timingMicros[timingLook] += ofGetElapsedTimeMicros() - start;
+        }
+        logBloomTiming();
+    }
+    
+    // The static layer was blended onto transparent black, so its
+    // colors are already multiplied by their alpha. Composite it as
+    // premultiplied, or text and image edges get their alpha twice.
+    updateStaticLayer();
+    ofPushStyle();
+    ofSetColor(255, 255, 255, 255);
+    ofEnableAlphaBlending();
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    staticLayer.draw(0, 0);
+    ofPopStyle();
+    
+    scoreText.set(font, score + currentLevel->getLineCount());
+    scoreText.draw(windowWidth - scoreText.getWidth() - 20, 20 + scoreText.getHeight());
+    
+    if (Telemetry::isEnabled()) {
+        Telemetry::drawHud(20, windowHeight - Telemetry::getHudHeight() - 20);
+    }
+    if (Tunables::isPanelVisible()) {
+        Tunables::drawPanel(windowWidth - TUNABLES_PANEL_WIDTH - 20, 80);
+    }
+    Telemetry::set(Telemetry::DRAW_MICROS, ofGetElapsedTimeMicros() - drawStart);
+    Telemetry::endFrame();
+    Allocations::endFrame();
+    
+    if (capturing) {
+        exportFbo.end();
+        captureFrame();
+        exportFrame++;
+        
+        // Show the frame in the window too, to follow progress.
+        ofSetColor(255, 255, 255, 255);
+        exportFbo.draw(0, 0, ofGetWidth(), ofGetHeight());
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::updateStaticLayer() {
+    TRACE_SCOPE("ofApp::updateStaticLayer");
+    bool resized = !staticLayer.isAllocated() ||
+                   staticLayer.getWidth() != (int)windowWidth ||
+                   staticLayer.getHeight() != (int)windowHeight;
+    if (resized) {
+        staticLayer.allocate(windowWidth, windowHeight, GL_RGBA);
+    }
+    if (!resized && staticLayerRevision == currentLevel->getStaticRevision() &&
+        staticLayerHelp == hkey) {
+        return;
+    }
+    staticLayerRevision = currentLevel->getStaticRevision();
+    staticLayerHelp = hkey;
+    
+    staticLayer.begin();
+    ofClear(0, 0, 0, 0);
+    currentLevel->drawStatic();
     
     // Draw help image if help key is pressed.
+    ofSetColor(255, 255, 255, 255);
     if (hkey) {
-        int imageWidth = instructions.getWidth();
-        int imageHeight = instructions.getHeight();
-        instructions.draw(ofPoint(windowWidth / 2 - imageWidth / 2,
+        int imageWidth = instructions->getWidth();
+        int imageHeight = instructions->getHeight();
+        instructions->draw(ofPoint(windowWidth / 2 - imageWidth / 2,
                                   windowHeight / 2 - imageHeight / 2),
                           imageWidth, imageHeight);
     }
     
     // Draw help instructions.
-    int imageWidth = help.getWidth();
-    int imageHeight = help.getHeight();
-    help.draw(ofPoint(20, 20), imageWidth, imageHeight);
+    int imageWidth = help->getWidth();
+    int imageHeight = help->getHeight();
+    help->draw(ofPoint(20, 20), imageWidth, imageHeight);
+    staticLayer.end();
+}
+
+//--------------------------------------------------------------
+void ofApp::setBloomTiming(bool enabled) {
+    if (enabled == bloomTiming) {
+        return;
+    }
+    bloomTiming = enabled;
+    if (enabled) {
+        timingQuality = bloom.getQuality();
+        timingLook = TIMING_RINGS;
+        for (int i = 0; i < TIMING_LOOKS; i++) {
+            timingMicros[i] = 0;
+        }
+        timedFrames = 0;
+        applyTimingLook();
+    }
+    else {
+        bloom.setQuality(timingQuality);
+        WaveRings::setEnabled(!waveField.isEnabled());
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::applyTimingLook() {
+    // Bloom is timed at the chosen quality, or at half resolution if
+    // it was off.
+    Bloom::Quality quality = timingQuality == Bloom::BLOOM_OFF ? Bloom::BLOOM_HALF : timingQuality;
+    WaveRings::setEnabled(timingLook == TIMING_RINGS);
+    bloom.setQuality(timingLook == TIMING_BLOOM ? quality : Bloom::BLOOM_OFF);
+}
+
+//--------------------------------------------------------------
+void ofApp::logBloomTiming() {
+    timedFrames++;
+    if (timedFrames < TIMING_FRAMES) {
+        return;
+    }
+    timedFrames = 0;
+    if (timingLook + 1 < TIMING_LOOKS) {
+        timingLook = (TimingLook)(timingLook + 1);
+        applyTimingLook();
+        return;
+    }
     
-    ostringstream ss;
-    ss << (score + currentLevel->getLineCount());
-    std::string scoreString = ss.str();
-    int stringWidth = font.stringWidth(scoreString);
-    int stringHeight = font.stringHeight(scoreString);
-    font.drawString(scoreString, windowWidth - stringWidth - 20, 20 + stringHeight);
+    // Compare each look's extra cost over a frame with neither.
+    long long rings = timingMicros[TIMING_RINGS] / (TIMING_FRAMES - 1);
+    long long glow = timingMicros[TIMING_BLOOM] / (TIMING_FRAMES - 1);
+    long long plain = timingMicros[TIMING_PLAIN] / (TIMING_FRAMES - 1);
+    ofLogNotice("Bloom") << "wave rings " << rings << " us/frame (" << rings - plain << " over plain), "
+                         << "bloom without rings " << glow << " us/frame (" << glow - plain << " over plain), "
+                         << "plain " << plain << " us/frame";
+    for (int i = 0; i < TIMING_LOOKS; i++) {
+        timingMicros[i] = 0;
+    }
+    timingLook = TIMING_RINGS;
+    applyTimingLook();
+}
+
+//--------------------------------------------------------------
+void ofApp::writeTrace() {
+    std::string path = ofToDataPath("trace-" + ofGetTimestampString() + ".json", true);
+    if (Trace::write(path)) {
+        ofLogNotice("Trace") << "Saved trace to " << path;
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::endLevelTelemetry() {
+    std::ostringstream ss;
+    ss << "telemetry-" << ofGetTimestampString() << "-level" << (currentLevelIndex + 1) << ".csv";
+    Telemetry::endLevel(ofToDataPath(ss.str(), true));
+    if (Telemetry::isEnabled()) {
+        Allocations::log();
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::onContactStart(ofxBox2dContactArgs &e) {
+    Telemetry::add(Telemetry::CONTACTS);
 }
 
 //--------------------------------------------------------------
 void ofApp::keyPressed(int key) {
+    SessionEvent event = { SessionEvent::KEY_PRESSED, key };
+    if (!acceptInput(event)) {
+        return;
+    }
+    
     // Pass on key events to level.
     currentLevel->keyPressed(key);
     
     // Do application-level key-handling.
     if (key == 't' || key == 'T') {
-        // Fullscreen.
-        ofToggleFullscreen();
+        // Fullscreen. Exports replay the recorded window size instead,
+        // see |windowResized|.
+        if (!replayingInput) {
+            ofToggleFullscreen();
+        }
     }
     else if (key == 'h' || key == 'H') {
         hkey = true;
     }
+    else if (key == 'e' || key == 'E') {
+        // Toggle endless mode.
+        endlessMode = !endlessMode;
+        prefetchNextLevel();
+    }
+    else if (key == 'l' || key == 'L') {
+        // Toggle live reloading of the level file.
+        liveReload = !liveReload;
+        watchLevel(currentLevelIndex);
+    }
+    else if (key == 'b' || key == 'B') {
+        // Cycle bloom off, quarter resolution, half resolution.
+        bloom.setQuality((Bloom::Quality)((bloom.getQuality() + 1) % 3));
+    }
+    else if (key == 'm' || key == 'M') {
+        // Toggle timing of the wave rings against bloom.
+        setBloomTiming(!bloomTiming);
+    }
+    else if (key == 'p' || key == 'P') {
+        // Start tracing, or stop and save the trace.
+        if (Trace::isEnabled()) {
+            writeTrace();
+        }
+        Trace::setEnabled(!Trace::isEnabled());
+    }
+    else if (key == 'c' || key == 'C') {
+        // Toggle telemetry counters, their HUD and CSV files.
+        Telemetry::setEnabled(!Telemetry::isEnabled());
+    }
+    else if (key == 'w' || key == 'W') {
+        // Toggle particle trails.
+        Level::setTrailsEnabled(!Level::getTrailsEnabled());
+    }
+    else if (key == 'f' || key == 'F') {
+        // Toggle the simulated wave field in place of the wave rings.
+        waveField.setEnabled(!waveField.isEnabled());
+        WaveRings::setEnabled(!waveField.isEnabled());
+        Level::setWaveField(waveField.isEnabled() ? &waveField : NULL);
+    }
+    else if (key == 'k' || key == 'K') {
+        // Toggle the tunables panel.
+        Tunables::setPanelVisible(!Tunables::isPanelVisible());
+    }
+    else if (Tunables::isPanelVisible() && (key == OF_KEY_UP || key == OF_KEY_DOWN)) {
+        Tunables::select(key == OF_KEY_UP ? -1 : 1);
+    }
+    else if (Tunables::isPanelVisible() && (key == OF_KEY_LEFT || key == OF_KEY_RIGHT)) {
+        Tunables::adjust(key == OF_KEY_LEFT ? -1 : 1);
+    }
+    else if (key == 'a' || key == 'A') {
+        // Log heap allocations by subsystem.
+        Allocations::log();
+    }
     else if (key == 'n' || key == 'N') {
         // Skip to next level.
+        endLevelTelemetry();
         score += currentLevel->getLineCount();
         delete currentLevel;
         currentLevel = loadNextLevel();
@@ -120,6 +558,11 @@ void ofApp::keyPressed(int key) {
 
 //--------------------------------------------------------------
 void ofApp::keyReleased(int key) {
+    SessionEvent event = { SessionEvent::KEY_RELEASED, key };
+    if (!acceptInput(event)) {
+        return;
+    }
+    
     if (key == 'h' || key == 'H') {
         hkey = false;
     }
@@ -127,32 +570,62 @@ void ofApp::keyReleased(int key) {
 
 //--------------------------------------------------------------
 void ofApp::mouseMoved(int x, int y ) {
+    SessionEvent event = { SessionEvent::MOUSE_MOVED, 0, (float)x, (float)y };
+    if (!acceptInput(event)) {
+        return;
+    }
+    
     // Pass on mouse events to level.
     currentLevel->mouseMoved(x, y);
 }
 
 //--------------------------------------------------------------
 void ofApp::mouseDragged(ofMouseEventArgs &e) {
+    SessionEvent event = { SessionEvent::MOUSE_DRAGGED, 0, e.x, e.y, e.button };
+    if (!acceptInput(event)) {
+        return;
+    }
+    
     // Pass on mouse events to level.
     currentLevel->mouseDragged(e);
 }
 
 //--------------------------------------------------------------
 void ofApp::mousePressed(ofMouseEventArgs &e) {
+    SessionEvent event = { SessionEvent::MOUSE_PRESSED, 0, e.x, e.y, e.button };
+    if (!acceptInput(event)) {
+        return;
+    }
+    
     // Pass on mouse events to level.
     currentLevel->mousePressed(e);
 }
 
 //--------------------------------------------------------------
 void ofApp::mouseReleased(ofMouseEventArgs &e) {
+    SessionEvent event = { SessionEvent::MOUSE_RELEASED, 0, e.x, e.y, e.button };
+    if (!acceptInput(event)) {
+        return;
+    }
+    
     // Pass on mouse events to level.
     currentLevel->mouseReleased(e);
 }
 
 //--------------------------------------------------------------
 void ofApp::windowResized(int w, int h) {
-    windowWidth = w;
-    windowHeight = h;
+    // Exports keep the recorded size whatever the window does.
+    SessionEvent event = { SessionEvent::WINDOW_RESIZED, 0, (float)w, (float)h, 0 };
+    if (acceptInput(event)) {
+        setWindowSize(w, h);
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::setWindowSize(int width, int height) {
+    windowWidth = width;
+    windowHeight = height;
+    Level::setWindowSize(width, height);
 }
 
 //--------------------------------------------------------------
@@ -171,3 +644,101 @@ void ofApp::audioOut(float *output, int bufferSize, int nChannels, int deviceID,
         sm->audioOut(output, bufferSize, nChannels, deviceID, tickCount);
     }
 }
+
+//--------------------------------------------------------------
+void ofApp::recordSession(const std::string path) {
+    recordPath = path;
+}
+
+//--------------------------------------------------------------
+void ofApp::exportSession(const std::string path, const std::string directory) {
+    exportPath = path;
+    exportDirectory = directory;
+}
+
+//--------------------------------------------------------------
+void ofApp::runBenchmarks(const std::string path) {
+    benchmarkPath = path;
+}
+
+//--------------------------------------------------------------
+void ofApp::runSweep(const std::string path) {
+    sweepPath = path;
+}
+
+//--------------------------------------------------------------
+void ofApp::usePreset(const std::string preset) {
+    this->preset = preset;
+}
+
+//--------------------------------------------------------------
+bool ofApp::isExporting() {
+    return !exportPath.empty();
+}
+
+//--------------------------------------------------------------
+bool ofApp::acceptInput(const SessionEvent& event) {
+    if (isExporting() && !replayingInput) {
+        return false;
+    }
+    recorder.event(event);
+    
+    // Input wakes the app up for the next frame.
+    lastActiveTime = ofGetElapsedTimef();
+    idle = false;
+    return true;
+}
+
+//--------------------------------------------------------------
+void ofApp::replayInput(const SessionFrame& frame) {
+    replayingInput = true;
+    for (int i = 0; i < frame.events.size(); i++) {
+        const SessionEvent& event = frame.events[i];
+        ofMouseEventArgs args;
+        args.x = event.x;
+        args.y = event.y;
+        args.button = event.button;
+        switch (event.type) {
+            case SessionEvent::KEY_PRESSED:
+                keyPressed(event.key);
+                break;
+            case SessionEvent::KEY_RELEASED:
+                keyReleased(event.key);
+                break;
+            case SessionEvent::MOUSE_MOVED:
+                mouseMoved(event.x, event.y);
+                break;
+            case SessionEvent::MOUSE_PRESSED:
+                mousePressed(args);
+                break;
+            case SessionEvent::MOUSE_DRAGGED:
+                mouseDragged(args);
+                break;
+            case SessionEvent::MOUSE_RELEASED:
+                mouseReleased(args);
+                break;
+            case SessionEvent::WINDOW_RESIZED:
+                setWindowSize(event.x, event.y);
+                break;
+        }
+    }
+    replayingInput = false;
+}
+
+//--------------------------------------------------------------
+void ofApp::captureFrame() {
+    // Read back the frame just drawn off-screen. Frame buffers are
+    // drawn upright, so no flip is needed.
+    exportFbo.readToPixels(exportPixels);
+    
+    std::ostringstream path;
+    path << exportDirectory << "/frame" << std::setw(6) << std::setfill('0') << exportFrame << ".png";
+    frameEncoder.add(exportPixels, path.str());
+}
+
+//--------------------------------------------------------------
+void ofApp::finishExport() {
+    frameEncoder.finish();
+    ofLogNotice("Export") << "Saved " << frameEncoder.getSavedCount() << " frames to " << exportDirectory;
+    ofExit();
+}
@@ -3,6 +3,17 @@
 #include "ofMain.h"
 #include "ofxBox2d.h"
 #include "Level.h"
+#include "LevelGenerator.h"
+#include "LevelPrefetcher.h"
+#include "AssetCache.h"
+#include "LevelWatcher.h"
+#include "CachedText.h"
+#include "Bloom.h"
+#include "WaveField.h"
+#include "GameClock.h"
+#include "Session.h"
+#include "FrameEncoder.h"
+#include "Benchmarks.h"
 #include "ofSoundMixer.h"
 
 class ofApp : public ofBaseApp {
@@ -26,6 +37,27 @@ public:
     
     void audioOut(float *output, int bufferSize, int nChannels, int deviceID, long unsigned long tickCount);
     
+    /* Records the session to a file at the given absolute path.
+     * Call before the app is run. */
+    void recordSession(const std::string path);
+    
+    /* Instead of playing, replays the recorded session at the given
+     * absolute path as fast as it renders, saves every frame as a
+     * PNG into |directory| and exits. Call before the app is run. */
+    void exportSession(const std::string path, const std::string directory);
+    
+    /* Runs the benchmarks on startup, writes the results to the given
+     * absolute path and exits. Call before the app is run. */
+    void runBenchmarks(const std::string path);
+    
+    /* Runs the scaling sweep on startup, writes the results to the
+     * given absolute path and exits. Call before the app is run. */
+    void runSweep(const std::string path);
+    
+    /* Loads |preset| from the tunables file instead of the preset
+     * the file names. Call before the app is run. */
+    void usePreset(const std::string preset);
+    
 private:    
     /* Current window width, height. */
     float windowWidth;
@@ -41,15 +73,143 @@ private:
     int currentLevelIndex = -1;
     Level* currentLevel;
     
+    /* Hand-written levels, from the level pack if there is one
+     * and from the text level files otherwise. */
+    LevelPack levelPack;
+    int levelCount = 0;
+    
     /* Cumulative player score. */
-    ofTrueTypeFont font;
+    std::shared_ptr<ofTrueTypeFont> font;
     int score = 0;
+    CachedText scoreText;
     
     /* Instructions */
-    ofImage instructions;
-    ofImage help;
+    std::shared_ptr<ofImage> instructions;
+    std::shared_ptr<ofImage> help;
     bool hkey = false;
     
+    /* Offscreen cache of the static layer: the level's boxes, lines
+     * and title plus the help overlay. Redrawn only when the level
+     * reports a change, the help key toggles or the window resizes. */
+    ofFbo staticLayer;
+    unsigned int staticLayerRevision = 0;
+    bool staticLayerHelp = false;
+    void updateStaticLayer();
+    
+    /* Optional glow over the dynamic layer. */
+    Bloom bloom;
+    
+    /* Optional simulated waves in place of the wave rings. */
+    WaveField waveField;
+    
+    /* When timing is on, the dynamic layer is drawn for
+     * |TIMING_FRAMES| frames each with only the wave rings, with only
+     * bloom and with neither, timed with the GPU synchronized, and
+     * the averages are logged after every round. This compares the
+     * glow of overdrawn rings with the bloom pass that could replace
+     * them. Bloom quality and the rings are restored afterwards. */
+    enum TimingLook {
+        TIMING_RINGS,
+        TIMING_BLOOM,
+        TIMING_PLAIN,
+        TIMING_LOOKS
+    };
+    bool bloomTiming = false;
+    TimingLook timingLook = TIMING_RINGS;
+    Bloom::Quality timingQuality = Bloom::BLOOM_OFF;
+    unsigned long long timingMicros[TIMING_LOOKS];
+    int timedFrames = 0;
+    void setBloomTiming(bool enabled);
+    void applyTimingLook();
+    void logBloomTiming();
+    
+    /* Saves the zones recorded by |Trace| to a timestamped file in
+     * the data directory. */
+    void writeTrace();
+    
+    /* Hands the frames of the level that just ended to |Telemetry|,
+     * which saves them as CSV in the data directory. */
+    void endLevelTelemetry();
+    void onContactStart(ofxBox2dContactArgs &e);
+    
+    /* Endless mode. Once the hand-written levels run out, further
+     * levels are generated in the background instead of wrapping
+     * around to the first level. */
+    bool endlessMode = false;
+    LevelGenerator levelGenerator;
+    
+    /* Prepares the next level in the background. */
+    LevelPrefetcher levelPrefetcher;
+    
+    /* Live reloading for level design. While enabled, edits to the
+     * current level's text file are applied to the running level. */
+    bool liveReload = false;
+    LevelWatcher levelWatcher;
+    LevelDescription watchedLevel;
+    
+    /* Tunables preset to load, or empty for the file's own choice. */
+    std::string preset;
+    
+    /* Where to write benchmark results, if benchmarking. */
+    std::string benchmarkPath;
+    
+    /* Where to write sweep results, if sweeping. */
+    std::string sweepPath;
+    
+    /* Session recording. */
+    std::string recordPath;
+    SessionRecorder recorder;
+    
+    /* Session export. While exporting, live input is ignored and the
+     * session's input is replayed instead, one frame per update. */
+    std::string exportPath;
+    std::string exportDirectory;
+    Session session;
+    int exportFrame = 0;
+    bool replayingInput = false;
+    ofFbo exportFbo;
+    ofPixels exportPixels;
+    FrameEncoder frameEncoder;
+    bool isExporting();
+    void replayInput(const SessionFrame& frame);
+    void captureFrame();
+    void finishExport();
+    
+    /* Sets the window size the game is laid out and played in. */
+    void setWindowSize(int width, int height);
+    
+    /* Records |event| and returns true, unless live input is being
+     * ignored because a session is being exported. */
+    bool acceptInput(const SessionEvent& event);
+    
+    /* Idling. Once nothing has moved and there has been no input for
+     * a while, frames are drawn at a low rate until something
+     * happens. The app still wakes for particle emissions right on
+     * time. */
+    bool idle = false;
+    float lastActiveTime = 0;
+    float lastUpdateTime = 0;
+    void updateIdle();
+    void waitWhileIdle();
+    bool isWorldAsleep();
+    
     /* Generator for game levels. */
     Level* loadNextLevel();
+    
+    /* Loads the hand-written level at |index|. */
+    Level* loadLevel(int index);
+    
+    /* Returns the text level file name for |index|. */
+    std::string getLevelFilename(int index);
+    
+    /* Returns the index of the level after the current one. */
+    int getNextLevelIndex();
+    
+    /* Asks the prefetcher to prepare the level after the current
+     * one, if it needs preparing. */
+    void prefetchNextLevel();
+    
+    /* Starts watching the file of level |index| if live reloading
+     * is enabled. */
+    void watchLevel(int index);
 };
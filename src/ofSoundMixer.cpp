@@ -1,35 +1,67 @@
 #include "ofSoundMixer.h"
+#include "Allocations.h"
+#include "Trace.h"
 
-#define SAMPLING_RATE 44100
+/* Pitch of strikes that have no source to take it from. */
+#define DEFAULT_STRIKE_FREQ 220.f
 
-ofSoundMixer::ofSoundMixer(ofBaseApp* app, int numSources) {
+/* Seconds of each sample kept read ahead of playback. */
+#define STREAM_AHEAD 0.5f
+
+ofSoundMixer::ofSoundMixer(ofBaseApp* app, int numSources, int sampleRate, int bufferSize)
+: sampleRate(sampleRate), strikeBuffer(bufferSize), resonators(sampleRate) {
     for (int i = 0; i < numSources; i++) {
         // Create sound properties
         SMSoundProperties properties;
         properties.volume = 0.f;
         properties.freq = 770.f - i * 110.f;
         sourceProperties.push_back(properties);
+        samplePositions.push_back(0);
     }
     
     // Create sound stream
-    stream.setup(app, 2, 0, 44100, 1024, 1);
+    if (app) {
+        stream.setup(app, 2, 0, sampleRate, bufferSize, 1);
+        hasStream = true;
+    }
 }
 
 ofSoundMixer::~ofSoundMixer() {
-    stream.stop();
-    stream.close();
+    if (hasStream) {
+        stream.stop();
+        stream.close();
+    }
 }
 
 int ofSoundMixer::AddSource(SMSoundProperties properties) {
+    TRACE_SCOPE("ofSoundMixer::AddSource");
+    AllocationScope allocationScope(Allocations::MIXER_CONTROL);
+    // The audio thread reads the source list, so growing it must
+    // be done under the lock.
+    mutex.lock();
     sourceProperties.push_back(properties);
-    return sourceProperties.size() - 1;
+    samplePositions.push_back(0);
+    int source = sourceProperties.size() - 1;
+    mutex.unlock();
+    return source;
 }
 
 bool ofSoundMixer::RemoveSource(int source) {
+    TRACE_SCOPE("ofSoundMixer::RemoveSource");
+    AllocationScope allocationScope(Allocations::MIXER_CONTROL);
+    mutex.lock();
+    if (source < 0 || source >= sourceProperties.size()) {
+        mutex.unlock();
+        return false;
+    }
     sourceProperties[source].volume = 0;
+    mutex.unlock();
+    return true;
 }
 
 void ofSoundMixer::Ping(int source, float volume, float duration) {
+    TRACE_SCOPE("ofSoundMixer::Ping");
+    AllocationScope allocationScope(Allocations::MIXER_CONTROL);
     if (source < 0 || source >= sourceProperties.size()) {
         std::cerr << "Invalid source ID (Ping)!" << std::endl;
         return;
@@ -40,6 +72,8 @@ void ofSoundMixer::Ping(int source, float volume, float duration) {
 }
 
 void ofSoundMixer::Play(int source, float volume) {
+    TRACE_SCOPE("ofSoundMixer::Play");
+    AllocationScope allocationScope(Allocations::MIXER_CONTROL);
     if (source < 0 || source >= sourceProperties.size()) {
         std::cerr << "Invalid source ID (Play)!" << std::endl;
         return;
@@ -50,6 +84,8 @@ void ofSoundMixer::Play(int source, float volume) {
 }
 
 void ofSoundMixer::Stop(int source) {
+    TRACE_SCOPE("ofSoundMixer::Stop");
+    AllocationScope allocationScope(Allocations::MIXER_CONTROL);
     if (source < 0 || source >= sourceProperties.size()) {
         std::cerr << "Invalid source ID (Stop)!" << std::endl;
         return;
@@ -59,12 +95,141 @@ void ofSoundMixer::Stop(int source) {
     mutex.unlock();
 }
 
+void ofSoundMixer::Strike(int source, ResonatorMaterial material, float strength) {
+    TRACE_SCOPE("ofSoundMixer::Strike");
+    AllocationScope allocationScope(Allocations::MIXER_CONTROL);
+    mutex.lock();
+    float freq = DEFAULT_STRIKE_FREQ;
+    if (source >= 0 && source < sourceProperties.size()) {
+        freq = sourceProperties[source].freq;
+    }
+    resonators.strike(material, freq, strength);
+    mutex.unlock();
+}
+
+int ofSoundMixer::AddSequence(const Sequence& sequence) {
+    TRACE_SCOPE("ofSoundMixer::AddSequence");
+    AllocationScope allocationScope(Allocations::MIXER_CONTROL);
+    mutex.lock();
+    
+    // Reuse the slot of a removed sequence.
+    int index = 0;
+    while (index < sequences.size() && sequenceActive[index]) {
+        index++;
+    }
+    if (index == sequences.size()) {
+        sequences.push_back(sequence);
+        sequenceActive.push_back(true);
+    }
+    else {
+        sequences[index] = sequence;
+        sequenceActive[index] = true;
+    }
+    mutex.unlock();
+    return index;
+}
+
+void ofSoundMixer::RemoveSequence(int sequence) {
+    TRACE_SCOPE("ofSoundMixer::RemoveSequence");
+    AllocationScope allocationScope(Allocations::MIXER_CONTROL);
+    if (sequence < 0 || sequence >= sequences.size()) {
+        std::cerr << "Invalid sequence ID (RemoveSequence)!" << std::endl;
+        return;
+    }
+    mutex.lock();
+    sequenceActive[sequence] = false;
+    
+    // Stop every note, whether or not it is sounding.
+    const std::vector<SequenceNote>& notes = sequences[sequence].getNotes();
+    for (int i = 0; i < notes.size(); i++) {
+        if (notes[i].value >= 0 && notes[i].value < sourceProperties.size()) {
+            sourceProperties[notes[i].value].volume = 0.f;
+        }
+    }
+    sequences[sequence] = Sequence();
+    mutex.unlock();
+}
+
+int ofSoundMixer::GetSampleRate() {
+    return sampleRate;
+}
+
+bool ofSoundMixer::LoadSampleBank(const std::string path) {
+    TRACE_SCOPE("ofSoundMixer::LoadSampleBank");
+    AllocationScope allocationScope(Allocations::MIXER_CONTROL);
+    mutex.lock();
+    
+    // Sources can't keep playing samples of another bank.
+    for (int i = 0; i < sourceProperties.size(); i++) {
+        sourceProperties[i].sample = -1;
+    }
+    bool loaded = sampleBank.open(path);
+    mutex.unlock();
+    
+    // Start reading the beginning of every sample in the background,
+    // so first notes don't wait on the disk.
+    for (int i = 0; i < sampleBank.getSampleCount(); i++) {
+        const SampleBankSample& sample = sampleBank.getSample(i);
+        sampleBank.prefetch(i, 0, STREAM_AHEAD * sample.sampleRate);
+        sampleBank.prefetch(i, sample.loopStart, STREAM_AHEAD * sample.sampleRate);
+    }
+    return loaded;
+}
+
+int ofSoundMixer::FindSample(const std::string name) {
+    return sampleBank.find(name);
+}
+
+void ofSoundMixer::Update() {
+    TRACE_SCOPE("ofSoundMixer::Update");
+    AllocationScope allocationScope(Allocations::MIXER_CONTROL);
+    if (!sampleBank.isOpen()) {
+        return;
+    }
+    mutex.lock();
+    streamingVoices.clear();
+    for (int i = 0; i < sourceProperties.size(); i++) {
+        if (sourceProperties[i].volume > 0.f && sourceProperties[i].sample != -1 && !SampleEnded(i)) {
+            streamingVoices.push_back(std::make_pair(i, samplePositions[i]));
+        }
+    }
+    mutex.unlock();
+    
+    // Voices pitched up read through their sample faster.
+    for (int i = 0; i < streamingVoices.size(); i++) {
+        const SMSoundProperties& properties = sourceProperties[streamingVoices[i].first];
+        const SampleBankSample& sample = sampleBank.getSample(properties.sample);
+        float speed = max(properties.freq / sample.rootFrequency, 1.f);
+        sampleBank.prefetch(properties.sample, streamingVoices[i].second, STREAM_AHEAD * sample.sampleRate * speed);
+    }
+}
+
 void ofSoundMixer::SetMode(SMSoundMode mode) {
     this->mode = mode;
 }
 
+int ofSoundMixer::GetActiveSourceCount() {
+    mutex.lock();
+    int count = activeSourceCount;
+    mutex.unlock();
+    return count;
+}
+
+int ofSoundMixer::GetRingingCount() {
+    mutex.lock();
+    int count = resonators.getRingingCount();
+    mutex.unlock();
+    return count;
+}
+
+void ofSoundMixer::SetMuted(bool muted) {
+    mutex.lock();
+    this->muted = muted;
+    mutex.unlock();
+}
+
 float ofSoundMixer::SampleSignal(int sourceID, int tick) {
-    float adjustedTick = (float)tick / SAMPLING_RATE;
+    float adjustedTick = (float)tick / sampleRate;
     float volume = sourceProperties[sourceID].volume;
     float freq = sourceProperties[sourceID].freq;
     float period = 1.f / freq;
@@ -87,20 +252,100 @@ float ofSoundMixer::SampleSignal(int sourceID, int tick) {
     }
 }
 
+bool ofSoundMixer::SampleEnded(int sourceID) {
+    const SampleBankSample& sample = sampleBank.getSample(sourceProperties[sourceID].sample);
+    return sample.loopEnd <= sample.loopStart && samplePositions[sourceID] >= sample.frameCount;
+}
+
+float ofSoundMixer::SampleVoice(int sourceID) {
+    const SMSoundProperties& properties = sourceProperties[sourceID];
+    const SampleBankSample& sample = sampleBank.getSample(properties.sample);
+    const int16_t* frames = sampleBank.getFrames(properties.sample);
+    double& position = samplePositions[sourceID];
+    
+    // Looping samples wrap around their loop; others end, see
+    // |SampleEnded|.
+    bool loops = sample.loopEnd > sample.loopStart;
+    if (loops && position >= sample.loopEnd) {
+        position = sample.loopStart + fmod(position - sample.loopStart, sample.loopEnd - sample.loopStart);
+    }
+    if (position >= sample.frameCount) {
+        return 0.f;
+    }
+    
+    // Resample by reading between frames.
+    int frame = position;
+    int next = frame + 1;
+    if (loops && next >= sample.loopEnd) {
+        next = sample.loopStart;
+    }
+    else if (next >= sample.frameCount) {
+        next = frame;
+    }
+    float fraction = position - frame;
+    float value = (frames[frame] + (frames[next] - frames[frame]) * fraction) / 32768.f;
+    position += (double)properties.freq / sample.rootFrequency * sample.sampleRate / sampleRate;
+    return properties.volume * value;
+}
+
 void ofSoundMixer::audioOut(float *output, int bufferSize, int nChannels, int deviceID, long unsigned long tickCount) {
-    mutex.lock();
+    TRACE_THREAD("audio");
+    TRACE_SCOPE("ofSoundMixer::audioOut");
+    AllocationScope allocationScope(Allocations::AUDIO_CALLBACK);
+    {
+        // Time spent waiting on the game thread.
+        TRACE_SCOPE("ofSoundMixer::lock");
+        mutex.lock();
+    }
     static int tick = 0;
     for(int i = 0; i < bufferSize * nChannels; i += nChannels) {
+        // Render contact sounds a buffer at a time.
+        int frame = i / nChannels;
+        int strikeFrame = frame % strikeBuffer.size();
+        if (strikeFrame == 0) {
+            TRACE_SCOPE("ofSoundMixer::resonators");
+            std::fill(strikeBuffer.begin(), strikeBuffer.end(), 0.f);
+            resonators.process(&strikeBuffer[0], min(bufferSize - frame, (int)strikeBuffer.size()));
+        }
+        
+        // Start and stop sequenced notes on this exact sample.
+        for (int j = 0; j < sequences.size(); j++) {
+            if (sequenceActive[j]) {
+                sequences[j].advance(1, [this](const SequenceNote& note, bool on) {
+                    if (note.value >= 0 && note.value < sourceProperties.size()) {
+                        sourceProperties[note.value].volume = on ? note.volume : 0.f;
+                    }
+                });
+            }
+        }
+        
         int activeSourceCount = 0;
         float audioSample = 0.f;
         for (int j = 0; j < sourceProperties.size(); j++) {
-            if (sourceProperties[j].volume > 0.f) {
+            if (sourceProperties[j].volume <= 0.f) {
+                // Samples start over with the next note.
+                samplePositions[j] = 0;
+            }
+            else if (sourceProperties[j].sample == -1) {
                 activeSourceCount++;
                 audioSample += SampleSignal(j, tick);
             }
+            else if (!SampleEnded(j)) {
+                // One-shot samples that have played out are inactive
+                // until their source is silenced.
+                activeSourceCount++;
+                audioSample += SampleVoice(j);
+            }
         }
-        audioSample /= activeSourceCount;
+        if (activeSourceCount > 0) {
+            audioSample /= activeSourceCount;
+        }
+        this->activeSourceCount = activeSourceCount;
+        audioSample = ofClamp(audioSample + strikeBuffer[strikeFrame], -1.f, 1.f);
         tick++;
+        if (muted) {
+            audioSample = 0.f;
+        }
         for (int j = 0; j < nChannels; j++) {
             output[i + j] = audioSample;
         }
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "ofMain.h"
+#include "ResonatorBank.h"
+#include "Sequence.h"
+#include "SampleBank.h"
 
 /* Sound modes. */
 typedef enum {
@@ -14,11 +17,17 @@ typedef enum {
 struct SMSoundProperties {
     float volume;
     float freq;
+    
+    /* Sample of the sample bank to play at |freq| instead of the
+     * oscillator, or -1. See |FindSample|. */
+    int sample = -1;
 };
 
 class ofSoundMixer {
 public:
-    ofSoundMixer(ofBaseApp* app, int numSources);
+    /* If |app| is NULL, no sound stream is opened and samples are
+     * only produced by calling |audioOut| directly. */
+    ofSoundMixer(ofBaseApp* app, int numSources, int sampleRate = 44100, int bufferSize = 1024);
     ~ofSoundMixer();
     
     /* Adds a sound source with the given sound properties. 
@@ -26,7 +35,8 @@ public:
      * play the sound source using functions below. */
     int AddSource(SMSoundProperties properties);
 
-    /* Removes the sound source with the given source ID. */
+    /* Silences the sound source with the given source ID. Returns
+     * false if there is no such source. */
     bool RemoveSource(int source);
     
     /* Ping/play/pause. Ping means the sound will be played and then
@@ -35,21 +45,85 @@ public:
     void Play(int source, float volume);
     void Stop(int source);
     
+    /* Rings a contact sound on the resonator bank, pitched from
+     * the given source, or from a default pitch if |source| is -1.
+     * |strength| is from 0 to 1. */
+    void Strike(int source, ResonatorMaterial material, float strength);
+    
+    /* Plays a sequence on the audio thread. Note values are source
+     * IDs and note volumes are the source volumes while the notes
+     * sound; ticks are samples, see |GetSampleRate|. Returns a
+     * sequence ID for |RemoveSequence|. */
+    int AddSequence(const Sequence& sequence);
+    
+    /* Stops a sequence and silences the sources it plays. */
+    void RemoveSequence(int sequence);
+    
+    int GetSampleRate();
+    
+    /* Maps the sample bank at the given absolute path, so sources can
+     * play recorded sounds. Returns false if it could not be opened. */
+    bool LoadSampleBank(const std::string path);
+    
+    /* Index of the bank's sample called |name| for
+     * |SMSoundProperties::sample|, or -1 if there is none. */
+    int FindSample(const std::string name);
+    
+    /* Reads ahead of every sounding sample voice, so long samples
+     * stream in from disk before the audio thread gets to them.
+     * Call once a frame. */
+    void Update();
+    
     /* Plays a pitch using the reserved reference source ID */
     void PlayPitch(int pitch);
     
     /* Sets the timbre. */
     void SetMode(SMSoundMode mode);
     
+    /* Number of sources that were sounding in the last audio
+     * callback. */
+    int GetActiveSourceCount();
+    
+    /* Number of contact sounds still ringing. */
+    int GetRingingCount();
+    
+    /* Silences the output without stopping any sources. */
+    void SetMuted(bool muted);
+    
     /* RtAudio callback. */
     void audioOut(float *output, int bufferSize, int nChannels, int deviceID, long unsigned long tickCount);
     
 private:
     float SampleSignal(int sourceID, int tick);
     
+    /* Next output sample of a source that plays a sample, resampled
+     * to its frequency. */
+    float SampleVoice(int sourceID);
+    
+    /* True if a source's sample doesn't loop and has played to its
+     * end, so it no longer counts as an active source. */
+    bool SampleEnded(int sourceID);
+    
     ofMutex mutex;
     SMSoundMode mode = SIN_MODE;
+    bool muted = false;
+    int activeSourceCount = 0;
     ofSoundStream stream;
+    bool hasStream = false;
     std::vector<SMSoundProperties> sourceProperties;
+    
+    /* Sample bank, and the play position of every source in its
+     * sample, in frames of the sample. */
+    SampleBank sampleBank;
+    std::vector<double> samplePositions;
+    
+    /* Sources to read ahead for, copied out by |Update| so the OS is
+     * advised without holding the lock. */
+    std::vector<std::pair<int, double> > streamingVoices;
+    std::vector<Sequence> sequences;
+    std::vector<bool> sequenceActive;
+    int sampleRate;
+    std::vector<float> strikeBuffer;
+    ResonatorBank resonators;
 };
 
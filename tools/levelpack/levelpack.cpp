@@ -0,0 +1,128 @@
+/* Compiles text level files into a binary level pack that the
+ * game can memory-map. Levels are stored in argument order.
+ *
+ *     levelpack <output.pack> <level1.txt> [level2.txt ...]
+ */
+
+#include "LevelDescription.h"
+#include "LevelPackFormat.h"
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/* Appends |count| records to |out| as raw bytes. */
+template <class T>
+static void writeRecords(FILE* out, const std::vector<T>& records) {
+    if (!records.empty()) {
+        fwrite(&records[0], sizeof(T), records.size(), out);
+    }
+}
+
+/* Places a section of |count| |recordSize| byte records at
+ * |offset| and advances |offset| past it. */
+static LevelPackSection placeSection(uint32_t& offset, size_t count, size_t recordSize) {
+    LevelPackSection section;
+    section.offset = offset;
+    section.count = count;
+    offset += count * recordSize;
+    return section;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <output.pack> <level.txt>..." << std::endl;
+        return 1;
+    }
+
+    std::vector<LevelPackLevel> levels;
+    std::vector<LevelPackBox> boxes;
+    std::vector<LevelPackSound> sounds;
+    std::vector<LevelPackSource> sources;
+    std::vector<LevelPackSink> sinks;
+    std::vector<int32_t> notes;
+    std::string strings;
+
+    for (int i = 2; i < argc; i++) {
+        LevelDescription description;
+        if (!description.loadFromFile(argv[i])) {
+            return 1;
+        }
+
+        LevelPackLevel level;
+        level.title = strings.size();
+        strings += description.title;
+        strings += '\0';
+
+        level.firstBox = boxes.size();
+        level.boxCount = description.boxes.size();
+        for (int j = 0; j < description.boxes.size(); j++) {
+            const BoxDescription& box = description.boxes[j];
+            LevelPackBox record = { box.x, box.y, box.width, box.height };
+            boxes.push_back(record);
+        }
+
+        level.firstSound = sounds.size();
+        level.soundCount = description.sounds.size();
+        for (int j = 0; j < description.sounds.size(); j++) {
+            const SoundDescription& sound = description.sounds[j];
+            LevelPackSound record = { sound.x, sound.y, sound.freq };
+            sounds.push_back(record);
+        }
+
+        level.firstSource = sources.size();
+        level.sourceCount = description.sources.size();
+        for (int j = 0; j < description.sources.size(); j++) {
+            const SourceDescription& source = description.sources[j];
+            LevelPackSource record = { source.x, source.y, (uint32_t)notes.size(), (uint32_t)source.pattern.size() };
+            sources.push_back(record);
+            notes.insert(notes.end(), source.pattern.begin(), source.pattern.end());
+        }
+
+        level.firstSink = sinks.size();
+        level.sinkCount = description.sinks.size();
+        for (int j = 0; j < description.sinks.size(); j++) {
+            const SinkDescription& sink = description.sinks[j];
+            LevelPackSink record = { sink.x, sink.y, sink.freq, sink.limit };
+            sinks.push_back(record);
+        }
+
+        levels.push_back(level);
+    }
+
+    // Every record is a multiple of 4 bytes, so laying the
+    // sections out back to back keeps them aligned.
+    LevelPackHeader header;
+    header.magic = LEVEL_PACK_MAGIC;
+    header.version = LEVEL_PACK_VERSION;
+    uint32_t offset = sizeof(LevelPackHeader);
+    header.levels = placeSection(offset, levels.size(), sizeof(LevelPackLevel));
+    header.boxes = placeSection(offset, boxes.size(), sizeof(LevelPackBox));
+    header.sounds = placeSection(offset, sounds.size(), sizeof(LevelPackSound));
+    header.sources = placeSection(offset, sources.size(), sizeof(LevelPackSource));
+    header.sinks = placeSection(offset, sinks.size(), sizeof(LevelPackSink));
+    header.notes = placeSection(offset, notes.size(), sizeof(int32_t));
+    header.strings = placeSection(offset, strings.size(), 1);
+
+    FILE* out = fopen(argv[1], "wb");
+    if (!out) {
+        std::cerr << "Could not open " << argv[1] << " for writing" << std::endl;
+        return 1;
+    }
+    fwrite(&header, sizeof(header), 1, out);
+    writeRecords(out, levels);
+    writeRecords(out, boxes);
+    writeRecords(out, sounds);
+    writeRecords(out, sources);
+    writeRecords(out, sinks);
+    writeRecords(out, notes);
+    fwrite(strings.data(), 1, strings.size(), out);
+    if (fclose(out) != 0) {
+        std::cerr << "Could not write " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::cout << "Packed " << levels.size() << " levels into " << argv[1] << std::endl;
+    return 0;
+}
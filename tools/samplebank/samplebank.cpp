@@ -0,0 +1,237 @@
+/* Decodes WAV files into a sample bank that the mixer can
+ * memory-map. Each argument names a sample and its file, and
+ * optionally the frequency the recording sounds at:
+ *
+ *     samplebank <output.bank> <name>=<file.wav>[@<root Hz>]...
+ *
+ * PCM and float WAV files of any channel count are mixed down to
+ * 16-bit mono at their own sample rate. The root frequency and loop
+ * points are taken from the file's smpl chunk when it has one, as
+ * written by most samplers; the root frequency on the command line
+ * overrides it and defaults to 440 Hz. Samples without a loop play
+ * once.
+ */
+
+#include "SampleBankFormat.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+/* Frequency of samples with no smpl chunk or command line root. */
+#define DEFAULT_ROOT_FREQUENCY 440.f
+
+/* A decoded WAV file. */
+struct Recording {
+    uint32_t sampleRate = 0;
+    std::vector<int16_t> frames;
+    float rootFrequency = 0;
+    uint32_t loopStart = 0, loopEnd = 0;
+};
+
+static uint32_t readU32(const unsigned char* p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint16_t readU16(const unsigned char* p) {
+    return p[0] | p[1] << 8;
+}
+
+/* Reads one sample of |bits| bits in |format| as -1 to 1. */
+static float readSample(const unsigned char* p, int format, int bits) {
+    if (format == 3 && bits == 32) {
+        float value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+    switch (bits) {
+        case 8: return (p[0] - 128) / 128.f;
+        case 16: return (int16_t)readU16(p) / 32768.f;
+        case 24: return (int32_t)(p[0] << 8 | p[1] << 16 | (uint32_t)p[2] << 24) / 2147483648.f;
+        case 32: return (int32_t)readU32(p) / 2147483648.f;
+        default: return 0;
+    }
+}
+
+/* Decodes the WAV file at |path|. Returns false and explains why if
+ * it can't. */
+static bool decode(const std::string path, Recording& recording) {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in) {
+        std::cerr << "Could not open " << path << std::endl;
+        return false;
+    }
+    std::vector<unsigned char> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (file.size() < 12 || memcmp(&file[0], "RIFF", 4) != 0 || memcmp(&file[8], "WAVE", 4) != 0) {
+        std::cerr << "Not a WAV file: " << path << std::endl;
+        return false;
+    }
+
+    int format = 0, channels = 0, bits = 0;
+    const unsigned char* data = NULL;
+    size_t dataSize = 0;
+    size_t offset = 12;
+    while (offset + 8 <= file.size()) {
+        const unsigned char* chunk = &file[offset];
+        size_t size = readU32(chunk + 4);
+        if (offset + 8 + size > file.size()) {
+            size = file.size() - offset - 8;
+        }
+        const unsigned char* body = chunk + 8;
+        if (memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+            format = readU16(body);
+            channels = readU16(body + 2);
+            recording.sampleRate = readU32(body + 4);
+            bits = readU16(body + 14);
+
+            // Extensible files keep the real format in the subformat.
+            if (format == 0xfffe && size >= 26) {
+                format = readU16(body + 24);
+            }
+        }
+        else if (memcmp(chunk, "data", 4) == 0) {
+            data = body;
+            dataSize = size;
+        }
+        else if (memcmp(chunk, "smpl", 4) == 0 && size >= 36) {
+            uint32_t unityNote = readU32(body + 12);
+            recording.rootFrequency = 440.f * pow(2.f, ((float)unityNote - 69) / 12);
+            if (readU32(body + 28) > 0 && size >= 60) {
+                // Loop end is inclusive in the file.
+                recording.loopStart = readU32(body + 36 + 8);
+                recording.loopEnd = readU32(body + 36 + 12) + 1;
+            }
+        }
+        offset += 8 + size + (size & 1);
+    }
+
+    if ((format != 1 && format != 3) || channels == 0 || recording.sampleRate == 0 ||
+        (bits != 8 && bits != 16 && bits != 24 && bits != 32)) {
+        std::cerr << "Unsupported WAV format in " << path << std::endl;
+        return false;
+    }
+    if (!data) {
+        std::cerr << "No audio data in " << path << std::endl;
+        return false;
+    }
+
+    // Mix all channels down to mono.
+    int frameSize = channels * bits / 8;
+    size_t frameCount = dataSize / frameSize;
+    recording.frames.resize(frameCount);
+    for (size_t i = 0; i < frameCount; i++) {
+        float sum = 0;
+        for (int j = 0; j < channels; j++) {
+            sum += readSample(data + i * frameSize + j * bits / 8, format, bits);
+        }
+        float value = fmax(-1.f, fmin(1.f, sum / channels));
+        recording.frames[i] = (int16_t)lrintf(value * 32767);
+    }
+    if (recording.loopEnd > frameCount || recording.loopStart >= recording.loopEnd) {
+        recording.loopStart = recording.loopEnd = 0;
+    }
+    return true;
+}
+
+/* Rounds |offset| up to a multiple of 4. */
+static uint32_t align(uint32_t offset) {
+    return (offset + 3) & ~3u;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <output.bank> <name>=<file.wav>[@<root Hz>]..." << std::endl;
+        return 1;
+    }
+
+    std::vector<SampleBankSample> samples;
+    std::vector<Recording> recordings;
+    std::string strings;
+
+    for (int i = 2; i < argc; i++) {
+        std::string argument = argv[i];
+        size_t equals = argument.find('=');
+        if (equals == std::string::npos || equals == 0) {
+            std::cerr << "Expected <name>=<file.wav>, got " << argument << std::endl;
+            return 1;
+        }
+        std::string name = argument.substr(0, equals);
+        std::string path = argument.substr(equals + 1);
+        float root = 0;
+        size_t at = path.rfind('@');
+        if (at != std::string::npos) {
+            root = atof(path.c_str() + at + 1);
+            path = path.substr(0, at);
+        }
+
+        recordings.push_back(Recording());
+        Recording& recording = recordings.back();
+        if (!decode(path, recording)) {
+            return 1;
+        }
+        if (recording.frames.empty()) {
+            std::cerr << path << " is empty" << std::endl;
+            return 1;
+        }
+        if (root > 0) {
+            recording.rootFrequency = root;
+        }
+        if (recording.rootFrequency <= 0) {
+            recording.rootFrequency = DEFAULT_ROOT_FREQUENCY;
+        }
+
+        SampleBankSample sample;
+        sample.name = strings.size();
+        strings += name;
+        strings += '\0';
+        sample.frameCount = recording.frames.size();
+        sample.sampleRate = recording.sampleRate;
+        sample.rootFrequency = recording.rootFrequency;
+        sample.loopStart = recording.loopStart;
+        sample.loopEnd = recording.loopEnd;
+        samples.push_back(sample);
+    }
+
+    // Records, then names, then each sample's PCM data, 4-byte aligned.
+    SampleBankHeader header;
+    header.magic = SAMPLE_BANK_MAGIC;
+    header.version = SAMPLE_BANK_VERSION;
+    header.samplesOffset = sizeof(SampleBankHeader);
+    header.sampleCount = samples.size();
+    header.stringsOffset = header.samplesOffset + samples.size() * sizeof(SampleBankSample);
+    header.stringsSize = strings.size();
+    uint32_t offset = align(header.stringsOffset + header.stringsSize);
+    for (int i = 0; i < samples.size(); i++) {
+        samples[i].dataOffset = offset;
+        offset = align(offset + samples[i].frameCount * sizeof(int16_t));
+    }
+
+    FILE* out = fopen(argv[1], "wb");
+    if (!out) {
+        std::cerr << "Could not open " << argv[1] << " for writing" << std::endl;
+        return 1;
+    }
+    const char padding[4] = { 0 };
+    fwrite(&header, sizeof(header), 1, out);
+    fwrite(&samples[0], sizeof(SampleBankSample), samples.size(), out);
+    fwrite(strings.data(), 1, strings.size(), out);
+    fwrite(padding, 1, align(header.stringsOffset + header.stringsSize) - (header.stringsOffset + header.stringsSize), out);
+    for (int i = 0; i < samples.size(); i++) {
+        size_t size = recordings[i].frames.size() * sizeof(int16_t);
+        fwrite(&recordings[i].frames[0], 1, size, out);
+        fwrite(padding, 1, align(size) - size, out);
+    }
+    if (fclose(out) != 0) {
+        std::cerr << "Could not write " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::cout << "Packed " << samples.size() << " samples into " << argv[1] << std::endl;
+    return 0;
+}
@@ -0,0 +1,89 @@
+/* Writes stress levels with given numbers of objects as level
+ * files, for finding where the game stops scaling:
+ *
+ *     stresslevels <directory> [<key>=<count>...]
+ *
+ * The keys are sources, pattern (notes per source), sounds, boxes
+ * and sinks, for the counts of the first level, and levels, first
+ * and seed. |levels| levels are written as level<first>.txt onwards,
+ * each with twice the objects of the one before. By default one
+ * level1.txt with one source and one sink is written.
+ */
+
+#include "StressLevel.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <directory> [sources=N] [pattern=N] [sounds=N] [boxes=N] [sinks=N]"
+                  << " [levels=N] [first=N] [seed=N]" << std::endl;
+        return 1;
+    }
+
+    StressParameters parameters;
+    int levels = 1, first = 1;
+    unsigned int seed = 1;
+    for (int i = 2; i < argc; i++) {
+        std::string argument = argv[i];
+        size_t equals = argument.find('=');
+        std::string key = argument.substr(0, equals);
+        int value = equals == std::string::npos ? -1 : atoi(argument.c_str() + equals + 1);
+        if (value < 0) {
+            std::cerr << "Expected <key>=<count>, got " << argument << std::endl;
+            return 1;
+        }
+        if (key == "sources") {
+            parameters.sources = value;
+        }
+        else if (key == "pattern") {
+            parameters.patternLength = value;
+        }
+        else if (key == "sounds") {
+            parameters.sounds = value;
+        }
+        else if (key == "boxes") {
+            parameters.boxes = value;
+        }
+        else if (key == "sinks") {
+            parameters.sinks = value;
+        }
+        else if (key == "levels") {
+            levels = value;
+        }
+        else if (key == "first") {
+            first = value;
+        }
+        else if (key == "seed") {
+            seed = value;
+        }
+        else {
+            std::cerr << "Unknown key " << key << std::endl;
+            return 1;
+        }
+    }
+
+    for (int i = 0; i < levels; i++) {
+        LevelDescription description;
+        StressLevel::generate(StressLevel::scale(parameters, 1 << i), seed + i, description);
+        std::ostringstream title;
+        title << first + i << ". " << description.title;
+        description.title = title.str();
+
+        std::ostringstream path;
+        path << argv[1] << "/level" << first + i << ".txt";
+        std::ofstream out(path.str().c_str());
+        description.write(out);
+        out.close();
+        if (!out) {
+            std::cerr << "Could not write " << path.str() << std::endl;
+            return 1;
+        }
+        std::cout << "Wrote " << path.str() << std::endl;
+    }
+    return 0;
+}